@@ -8,14 +8,24 @@
 #include <ndn-cxx/util/scheduler.hpp>
 
 #include <boost/asio/io_context.hpp>
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
 #include <iostream>
 #include <map>
 #include <optional>
 #include <set>
+#include <sstream>
+#include <vector>
 #include <unistd.h>
 
+#include "event-log.hpp"
+#include "fec.hpp"
+#include "signing-mode.hpp"
+
 namespace ndn {
 namespace examples {
 
@@ -23,10 +33,17 @@ namespace examples {
 // number in Data MetaInfo. Must match the producer (TLV_LIVE_EDGE / 206).
 constexpr uint32_t TLV_LIVE_EDGE = 206;
 
+// Application-level TLV type carrying the frame manifest in segment 0: implicit
+// digests of segments 1..K-1. Must match the producer (TLV_FRAME_MANIFEST / 207).
+constexpr uint32_t TLV_FRAME_MANIFEST = 207;
+
 // Generic name component marking a live-edge discovery Interest (<stream>/_meta).
 // Must match the producer.
 constexpr char DISCOVERY_MARKER[] = "_meta";
 
+// Trust schema for the asymmetric signing modes (see loadTrustSchema).
+constexpr char TRUST_SCHEMA_FILE[] = "/home/vagrant/flooding/experiment/app/trust-schema.conf";
+
 /**
  * @brief Pull-based live-stream consumer that tracks the producer live edge via
  *        Data feedback (no shared clock).
@@ -34,12 +51,19 @@ constexpr char DISCOVERY_MARKER[] = "_meta";
  * On join the consumer discovers the current edge with a MustBeFresh
  * "<stream>/_meta" Interest. It then keeps a lookahead of EXP_WINDOW_FRAMES
  * frames ahead of the edge, fetching each frame as a versioned, segmented object
- * (/<stream>/<version=frame>/<segment>): segment 0 first, its FinalBlockId
- * reveals the segment count K, then the remaining segments. Every received Data
+ * (/<stream>/<version=frame>/<segment>): every segment the frame is expected to
+ * have is requested at once, and the FinalBlockId of the first to arrive gives
+ * the actual count. With parity (TLV_FEC_PARITY, see fec.hpp) it fetches all K+R
+ * and completes the frame from the first K to arrive. Every received Data
  * reports the current edge, so the consumer slides its window forward; after a
  * disruption it jumps to the latest edge (skipping stale frames), which is the
  * live-streaming "skip to live" behaviour. The frames requested ahead of the
  * edge are the producer-parked Interests that OptoFlood floods on a hand-off.
+ *
+ * With quality layers (EXP_LAYERS, the per-layer K listed from the lightest, as
+ * given to the producer) each frame is fetched from <stream>/l<layer>; the
+ * layer is chosen per frame by adaptLayer from the measured frame fetch interval
+ * and goodput, starting from the lightest.
  */
 class Consumer : noncopyable
 {
@@ -53,6 +77,18 @@ public:
     m_streamPrefix = Name(rawStreamPrefix && rawStreamPrefix[0] != '\0'
                           ? rawStreamPrefix : "/LiveStream/v0");
 
+    // Binary per-packet event log (EXP_EVENT_LOG=<file>); text logging otherwise.
+    m_eventLog = EventLog::openFromEnv();
+    if (m_eventLog) {
+      m_logPrefixId = m_eventLog->definePrefix(m_streamPrefix);
+    }
+
+    for (const char* p = std::getenv("EXP_LAYERS"); p != nullptr && *p != '\0'; ) {
+      m_layerSegments.push_back(std::max(1, std::atoi(p)));
+      p = std::strchr(p, ',');
+      p = p != nullptr ? p + 1 : nullptr;
+    }
+
     const char* rawWindow = std::getenv("EXP_WINDOW_FRAMES");
     m_windowFrames = rawWindow ? std::atoi(rawWindow) : 4;
     if (m_windowFrames <= 0) {
@@ -67,6 +103,7 @@ public:
     if (framePeriodMs <= 0) {
       framePeriodMs = 20;
     }
+    m_framePeriod = time::milliseconds(framePeriodMs);
 
     // Per-frame timeout = lookahead (m_windowFrames * framePeriod) plus a reclaim
     // margin. It is the Interest lifetime and the slot-reclaim deadline, not a
@@ -76,21 +113,36 @@ public:
     static constexpr int kReclaimMarginMs = 2000;
     int timeoutMs = m_windowFrames * framePeriodMs + kReclaimMarginMs;
     m_frameTimeout = time::milliseconds(timeoutMs);
+
+    // Signature algorithm (EXP_SIGNING, default ecdsa); must match the producer.
+    m_signingMode = signingModeFromEnv();
+    if (m_signingMode == SigningMode::HMAC) {
+      m_hmacVerifier.emplace(hmacKeyFromEnv());
+    }
   }
 
   void
   run()
   {
-    try {
-      m_validator.load("/home/vagrant/flooding/experiment/app/trust-schema.conf");
-    }
-    catch (const std::exception& e) {
-      std::cerr << "ERROR: Failed to load trust schema: " << e.what() << std::endl;
-      return;
+    // Asymmetric modes are checked against the trust schema; the symmetric modes
+    // carry no certificate and are verified directly in onData.
+    if (isAsymmetric(m_signingMode)) {
+      try {
+        loadTrustSchema(TRUST_SCHEMA_FILE);
+      }
+      catch (const std::exception& e) {
+        std::cerr << "ERROR: Failed to load trust schema: " << e.what() << std::endl;
+        return;
+      }
     }
+    std::cout << "[" << nowNs() << "] STARTUP: signing mode " << toString(m_signingMode) << std::endl;
 
     std::cout << "[" << nowNs() << "] STARTUP: window " << m_windowFrames
               << " frames, frame timeout " << m_frameTimeout.count() << " ms" << std::endl;
+    if (!m_layerSegments.empty()) {
+      std::cout << "[" << nowNs() << "] STARTUP: " << m_layerSegments.size()
+                << " quality layers, starting at " << layerPrefix(m_layer) << std::endl;
+    }
 
     sendDiscovery();
     m_ioContext.run();
@@ -98,13 +150,174 @@ public:
 
 private:
   struct FrameState {
-    int expectedSegments = 0;   // known once segment 0 (FinalBlockId) is received
+    int expectedSegments = 0;   // known once any segment (FinalBlockId) is received
     bool finalKnown = false;
+    int requestedSegments = 0;  // segments 0 .. requestedSegments-1 are requested
     std::set<uint64_t> received;
+    // With FEC: K of the expectedSegments, the received contents and the frame
+    // bytes (from a parity segment), kept to rebuild missing source segments.
+    int sourceSegments = 0;
+    std::map<uint64_t, std::vector<uint8_t>> contents;
+    size_t frameBytes = 0;
+    int layer = 0;              // quality layer the frame is fetched from
+    uint64_t firstDataNs = 0;   // arrival of the first segment, once the frame exists
+    size_t bytesReceived = 0;
     uint64_t startTimeNs = 0;
     scheduler::ScopedEventId deadlineEvent;
   };
 
+  // Load the trust schema with its "sig-type" set to the configured asymmetric
+  // algorithm, so a single schema file serves every EXP_SIGNING mode.
+  void
+  loadTrustSchema(const std::string& filename)
+  {
+    std::ifstream file(filename);
+    if (!file) {
+      throw std::runtime_error("Cannot open " + filename);
+    }
+    std::ostringstream schema;
+    std::string line;
+    while (std::getline(file, line)) {
+      auto pos = line.find("sig-type");
+      if (pos != std::string::npos) {
+        line = line.substr(0, pos) + "sig-type " + trustSchemaSigType(m_signingMode);
+      }
+      schema << line << '\n';
+    }
+    m_validator.load(schema.str(), filename);
+  }
+
+  // Verify a self-signed Data for the configured signing mode; onVerified, if set,
+  // runs once the signature is accepted.
+  void
+  verifySignature(const Data& data, uint64_t recvTimestamp,
+                  std::function<void(const Data&)> onVerified = nullptr)
+  {
+    auto onValid = [this, recvTimestamp, onVerified] (const Data& d) {
+      if (!m_eventLog || !m_eventLog->record(EventType::VALIDATED, d.getName())) {
+        std::cout << "[" << recvTimestamp << "] VALIDATE: Data signature verified" << std::endl;
+      }
+      if (onVerified) {
+        onVerified(d);
+      }
+    };
+    auto onInvalid = [recvTimestamp] (const Data&, const security::ValidationError& error) {
+      std::cerr << "[" << recvTimestamp << "] ERROR: Data validation failed: " << error << std::endl;
+    };
+
+    switch (m_signingMode) {
+      case SigningMode::ECDSA:
+      case SigningMode::RSA:
+        m_validator.validate(data, onValid, onInvalid);
+        return;
+      case SigningMode::HMAC:
+        if (m_hmacVerifier->verify(data)) {
+          onValid(data);
+        }
+        else {
+          onInvalid(data, security::ValidationError(security::ValidationError::INVALID_SIGNATURE,
+                                                    "HMAC mismatch"));
+        }
+        return;
+      case SigningMode::DIGEST:
+        if (verifyDigestSignature(data)) {
+          onValid(data);
+        }
+        else {
+          onInvalid(data, security::ValidationError(security::ValidationError::INVALID_SIGNATURE,
+                                                    "digest mismatch"));
+        }
+        return;
+    }
+  }
+
+  // A DigestSha256 segment outside the digest signing mode is covered by the
+  // manifest carried in segment 0 of its frame.
+  bool
+  isManifestCovered(const Data& data) const
+  {
+    return m_signingMode != SigningMode::DIGEST &&
+           data.getSignatureInfo().getSignatureType() == tlv::DigestSha256;
+  }
+
+  // Adopt the manifest of a verified segment 0, then settle the segments of that
+  // frame which arrived before it.
+  void
+  recordManifest(uint64_t frame, const Data& head)
+  {
+    const Block* block = head.getMetaInfo().findAppMetaInfo(TLV_FRAME_MANIFEST);
+    if (block == nullptr) {
+      return;
+    }
+    std::vector<name::Component> digests;
+    try {
+      block->parse();
+      for (const auto& element : block->elements()) {
+        digests.emplace_back(element);
+      }
+    }
+    catch (const tlv::Error& e) {
+      std::cerr << "[" << nowNs() << "] ERROR: Malformed frame manifest: " << e.what() << std::endl;
+      return;
+    }
+    auto& manifest = m_manifests[frame] = std::move(digests);
+
+    auto range = m_awaitingManifest.equal_range(frame);
+    for (auto it = range.first; it != range.second; ++it) {
+      checkDigest(manifest, it->second.segment, *it->second.data, it->second.recvTimestamp);
+    }
+    m_awaitingManifest.erase(range.first, range.second);
+    pruneManifests();
+  }
+
+  void
+  checkAgainstManifest(uint64_t frame, uint64_t segment, const Data& data, uint64_t recvTimestamp)
+  {
+    auto it = m_manifests.find(frame);
+    if (it != m_manifests.end()) {
+      checkDigest(it->second, segment, data, recvTimestamp);
+      return;
+    }
+    m_awaitingManifest.emplace(frame, AwaitingManifest{segment, make_shared<Data>(data), recvTimestamp});
+    pruneManifests();
+  }
+
+  void
+  checkDigest(const std::vector<name::Component>& manifest, uint64_t segment,
+              const Data& data, uint64_t recvTimestamp)
+  {
+    if (segment >= 1 && segment <= manifest.size() &&
+        data.getFullName().get(-1) == manifest[segment - 1]) {
+      if (!m_eventLog ||
+          !m_eventLog->record(EventType::VALIDATED, data.getName(), 0, 0, 0, 0, 1)) {
+        std::cout << "[" << recvTimestamp << "] VALIDATE: Data digest matches frame manifest" << std::endl;
+      }
+    }
+    else {
+      std::cerr << "[" << recvTimestamp << "] ERROR: Data validation failed: "
+                << "digest not in frame manifest" << std::endl;
+    }
+  }
+
+  // Manifests are kept for a few windows behind the live edge, so late duplicate
+  // segments can still be checked; segments whose manifest never arrived fail.
+  void
+  pruneManifests()
+  {
+    uint64_t retention = 2 * static_cast<uint64_t>(m_windowFrames) + MANIFEST_RETENTION_MARGIN;
+    if (m_edge <= retention) {
+      return;
+    }
+    uint64_t oldest = m_edge - retention;
+    m_manifests.erase(m_manifests.begin(), m_manifests.lower_bound(oldest));
+    auto stale = m_awaitingManifest.lower_bound(oldest);
+    for (auto it = m_awaitingManifest.begin(); it != stale; ++it) {
+      std::cerr << "[" << it->second.recvTimestamp << "] ERROR: Data validation failed: "
+                << "frame manifest unavailable" << std::endl;
+    }
+    m_awaitingManifest.erase(m_awaitingManifest.begin(), stale);
+  }
+
   static uint64_t
   nowNs()
   {
@@ -115,7 +328,13 @@ private:
   static std::optional<uint64_t>
   readEdge(const Data& data)
   {
-    const Block* block = data.getMetaInfo().findAppMetaInfo(TLV_LIVE_EDGE);
+    return readAppInteger(data, TLV_LIVE_EDGE);
+  }
+
+  static std::optional<uint64_t>
+  readAppInteger(const Data& data, uint32_t type)
+  {
+    const Block* block = data.getMetaInfo().findAppMetaInfo(type);
     if (block == nullptr) {
       return std::nullopt;
     }
@@ -127,12 +346,22 @@ private:
     }
   }
 
+  // Name prefix of a quality layer; the stream prefix itself without layers.
+  Name
+  layerPrefix(int layer) const
+  {
+    if (m_layerSegments.empty()) {
+      return m_streamPrefix;
+    }
+    return Name(m_streamPrefix).append(("l" + std::to_string(layer)).c_str());
+  }
+
   // Discover (or re-acquire) the current live edge. Retried until the producer
   // responds, which also covers start-up and recovery from a long outage.
   void
   sendDiscovery()
   {
-    Name name(m_streamPrefix);
+    Name name(layerPrefix(m_layer));
     name.append(name::Component(DISCOVERY_MARKER));
 
     Interest interest(name);
@@ -207,16 +436,45 @@ private:
     m_framesRequested++;
     FrameState& st = m_frames[frame];
     st.startTimeNs = nowNs();
+    st.layer = m_layer;
     st.deadlineEvent = m_scheduler.schedule(m_frameTimeout, [this, frame] { onFrameDeadline(frame); });
 
-    std::cout << "[" << nowNs() << "] FRAME: start frame=" << frame << std::endl;
-    requestSegment(frame, 0);
+    if (m_eventLog) {
+      m_eventLog->record(EventType::FRAME_STARTED, m_logPrefixId, frame, 0);
+    }
+    else {
+      std::cout << "[" << nowNs() << "] FRAME: start frame=" << frame << std::endl;
+    }
+    // All at once, so every segment is parked at the producer and released with
+    // the frame: any K of K+R complete it, segment 0 included, with no second
+    // round trip. The count is a guess until a segment brings FinalBlockId.
+    requestSegments(frame, st, guessSegments(st.layer));
+  }
+
+  // Segments per frame before the frame's own FinalBlockId is known: the layer's
+  // K (EXP_LAYERS) or else the last frame's count, plus the last parity seen.
+  int
+  guessSegments(int layer) const
+  {
+    if (!m_layerSegments.empty()) {
+      return m_layerSegments[layer] + m_lastParity;
+    }
+    return std::max(1, m_lastFrameSegments);
+  }
+
+  void
+  requestSegments(uint64_t frame, FrameState& st, int count)
+  {
+    for (; st.requestedSegments < count; ++st.requestedSegments) {
+      requestSegment(frame, static_cast<uint64_t>(st.requestedSegments));
+    }
   }
 
   void
   requestSegment(uint64_t frame, uint64_t segment)
   {
-    Name name(m_streamPrefix);
+    auto it = m_frames.find(frame);
+    Name name(layerPrefix(it != m_frames.end() ? it->second.layer : m_layer));
     name.appendVersion(frame);
     name.appendSegment(segment);
 
@@ -226,8 +484,13 @@ private:
     interest.setInterestLifetime(m_frameTimeout);
 
     m_interestsSent++;
-    std::cout << "[" << nowNs() << "] SEND: frame=" << frame << " seg=" << segment
-              << " Name: " << name << std::endl;
+    if (m_eventLog) {
+      m_eventLog->record(EventType::INTEREST_SENT, m_logPrefixId, frame, segment);
+    }
+    else {
+      std::cout << "[" << nowNs() << "] SEND: frame=" << frame << " seg=" << segment
+                << " Name: " << name << std::endl;
+    }
 
     m_face.expressInterest(interest,
                            [this] (const Interest& i, const Data& d) { onData(i, d); },
@@ -239,7 +502,6 @@ private:
   onData(const Interest&, const Data& data)
   {
     auto recvTimestamp = nowNs();
-    m_segmentsReceived++;
 
     // Track the live edge reported by the producer (feedback), regardless of
     // whether this Data belongs to a frame still in the window.
@@ -247,6 +509,16 @@ private:
       updateEdge(*edge);
     }
 
+    // An application Nack: the producer refused to hold the Interest (its reason
+    // is the content). Handled like a network Nack, after taking its edge.
+    if (data.getContentType() == tlv::ContentType_Nack) {
+      m_nacks++;
+      std::cerr << "[" << recvTimestamp << "] NACK: " << data.getName() << " Reason: app "
+                << readString(data.getContent()) << std::endl;
+      return;
+    }
+    m_segmentsReceived++;
+
     const Name& name = data.getName();
     uint64_t frame = 0;
     uint64_t segment = 0;
@@ -262,27 +534,47 @@ private:
       return;
     }
 
-    std::cout << "[" << recvTimestamp << "] DATA: frame=" << frame << " seg=" << segment
-              << " Size: " << data.wireEncode().size() << " bytes" << std::endl;
+    if (m_eventLog) {
+      m_eventLog->record(EventType::DATA_RECEIVED, m_logPrefixId, frame, segment,
+                         data.wireEncode().size());
+    }
+    else {
+      std::cout << "[" << recvTimestamp << "] DATA: frame=" << frame << " seg=" << segment
+                << " Size: " << data.wireEncode().size() << " bytes" << std::endl;
+    }
 
-    // Validate the signature against the trust schema. Reception accounting does
-    // not gate on validation; the result is logged for trust verification.
-    m_validator.validate(data,
-      [recvTimestamp] (const Data&) {
-        std::cout << "[" << recvTimestamp << "] VALIDATE: Data signature verified" << std::endl;
-      },
-      [recvTimestamp] (const Data&, const security::ValidationError& error) {
-        std::cerr << "[" << recvTimestamp << "] ERROR: Data validation failed: " << error << std::endl;
-      });
+    // Validate the signature for the configured signing mode, or, for segments
+    // covered by a frame manifest, their digest against it. Reception accounting
+    // does not gate on validation; the result is logged for trust verification.
+    if (isManifestCovered(data)) {
+      checkAgainstManifest(frame, segment, data, recvTimestamp);
+    }
+    else if (segment == 0) {
+      verifySignature(data, recvTimestamp,
+                      [this, frame] (const Data& head) { recordManifest(frame, head); });
+    }
+    else {
+      verifySignature(data, recvTimestamp);
+    }
 
     auto it = m_frames.find(frame);
     if (it == m_frames.end()) {
       return;  // frame already completed, lost, or skipped
     }
     FrameState& st = it->second;
+    if (name.getPrefix(-2) != layerPrefix(st.layer)) {
+      return;  // the frame is fetched from another layer
+    }
     st.received.insert(segment);
+    st.bytesReceived += data.getContent().value_size();
+    if (st.firstDataNs == 0) {
+      st.firstDataNs = recvTimestamp;
+      recordFirstArrival(frame, recvTimestamp);
+    }
 
-    if (segment == 0 && !st.finalKnown) {
+    // Every segment carries FinalBlockId and the parity count, so the first to
+    // arrive settles the frame's layout, whichever it is.
+    if (!st.finalKnown) {
       auto finalBlock = data.getFinalBlock();
       if (finalBlock && finalBlock->isSegment()) {
         st.expectedSegments = static_cast<int>(finalBlock->toSegment()) + 1;
@@ -290,18 +582,71 @@ private:
       else {
         st.expectedSegments = 1;
       }
+      // FinalBlockId covers the parity segments too.
+      auto parity = readAppInteger(data, fec::TLV_FEC_PARITY).value_or(0);
+      st.sourceSegments = parity > 0 && parity < static_cast<uint64_t>(st.expectedSegments)
+                          ? st.expectedSegments - static_cast<int>(parity) : 0;
       st.finalKnown = true;
+      m_lastFrameSegments = st.expectedSegments;
+      m_lastParity = st.sourceSegments > 0 ? st.expectedSegments - st.sourceSegments : 0;
+      // Those the guess fell short of; any past the last one go unanswered.
+      requestSegments(frame, st, st.expectedSegments);
+    }
 
-      for (uint64_t s = 1; s < static_cast<uint64_t>(st.expectedSegments); ++s) {
-        requestSegment(frame, s);
+    if (data.getMetaInfo().findAppMetaInfo(fec::TLV_FEC_PARITY) != nullptr) {
+      const Block& content = data.getContent();
+      st.contents[segment].assign(content.value_begin(), content.value_end());
+      if (auto frameBytes = readAppInteger(data, fec::TLV_FEC_FRAME_BYTES)) {
+        st.frameBytes = *frameBytes;
       }
     }
 
-    if (st.finalKnown && static_cast<int>(st.received.size()) >= st.expectedSegments) {
+    if (!st.finalKnown) {
+      return;
+    }
+    if (st.sourceSegments > 0) {
+      if (static_cast<int>(st.received.size()) >= st.sourceSegments) {
+        recoverFrame(frame, st);
+        completeFrame(frame);
+      }
+    }
+    else if (static_cast<int>(st.received.size()) >= st.expectedSegments) {
       completeFrame(frame);
     }
   }
 
+  // Rebuild the source segments of a frame that did not arrive from the parity
+  // segments that did; any K of the K+R suffice.
+  void
+  recoverFrame(uint64_t frame, FrameState& st)
+  {
+    std::vector<std::vector<uint8_t>> segments(st.expectedSegments);
+    std::vector<bool> isReceived(st.expectedSegments, false);
+    for (auto& [segment, content] : st.contents) {
+      if (segment < segments.size()) {
+        segments[segment] = std::move(content);
+        isReceived[segment] = true;
+      }
+    }
+    st.contents.clear();
+    int missing = static_cast<int>(std::count(isReceived.begin(), isReceived.begin() + st.sourceSegments,
+                                              false));
+    if (missing == 0) {
+      return;
+    }
+    try {
+      if (fec::recover(segments, isReceived, st.sourceSegments, st.frameBytes)) {
+        m_fecRecovered += missing;
+        std::cout << "[" << nowNs() << "] FEC: recovered " << missing << " segments frame=" << frame
+                  << " (recovered " << m_fecRecovered << ")" << std::endl;
+      }
+    }
+    catch (const std::exception& e) {
+      std::cerr << "[" << nowNs() << "] ERROR: FEC recovery failed frame=" << frame << ": "
+                << e.what() << std::endl;
+    }
+  }
+
   void
   completeFrame(uint64_t frame)
   {
@@ -311,11 +656,18 @@ private:
     }
     auto latencyNs = nowNs() - it->second.startTimeNs;
     m_framesDelivered++;
+    adaptLayer(frame, it->second, false);
 
-    std::cout << "[" << nowNs() << "] FRAME: delivered frame=" << frame
-              << " latency_ms=" << latencyNs / 1000000.0
-              << " (delivered " << m_framesDelivered << ", lost " << m_framesLost
-              << ", skipped " << m_framesSkipped << ")" << std::endl;
+    if (m_eventLog) {
+      m_eventLog->record(EventType::FRAME_DELIVERED, m_logPrefixId, frame, 0, latencyNs,
+                         m_framesDelivered, m_framesLost, m_framesSkipped);
+    }
+    else {
+      std::cout << "[" << nowNs() << "] FRAME: delivered frame=" << frame
+                << " latency_ms=" << latencyNs / 1000000.0
+                << " (delivered " << m_framesDelivered << ", lost " << m_framesLost
+                << ", skipped " << m_framesSkipped << ")" << std::endl;
+    }
 
     m_frames.erase(it);   // cancels the per-frame deadline event
     ensureWindow();
@@ -329,6 +681,7 @@ private:
       return;   // already completed
     }
     m_framesLost++;
+    adaptLayer(frame, it->second, true);
 
     std::cerr << "[" << nowNs() << "] FRAME: lost frame=" << frame
               << " (timeout; delivered " << m_framesDelivered << ", lost " << m_framesLost
@@ -344,6 +697,99 @@ private:
     }
   }
 
+  // Track the base delay: the smallest lag, over the last ABR_BASE_FRAMES
+  // frames, of a frame's first segment behind its nominal time frame * period.
+  // The producer's start time and the path delay are folded into it, so base
+  // delay + frame * period is when a parked frame's data can first be here.
+  void
+  recordFirstArrival(uint64_t frame, uint64_t arrivalNs)
+  {
+    if (m_layerSegments.empty()) {
+      return;
+    }
+    int64_t lag = static_cast<int64_t>(arrivalNs) - static_cast<int64_t>(frame * periodNs());
+    while (!m_arrivalLags.empty() && m_arrivalLags.back().second >= lag) {
+      m_arrivalLags.pop_back();
+    }
+    m_arrivalLags.emplace_back(frame, lag);
+    while (m_arrivalLags.front().first + ABR_BASE_FRAMES <= frame) {
+      m_arrivalLags.pop_front();
+    }
+  }
+
+  uint64_t
+  periodNs() const
+  {
+    return static_cast<uint64_t>(time::nanoseconds(m_framePeriod).count());
+  }
+
+  /**
+   * @brief Pick the layer of the frames requested next from the outcome of one
+   *        fetched from the current layer.
+   *
+   * A frame's fetch interval runs from when its data could first be here, its
+   * request or its nominal time plus the base delay (see recordFirstArrival),
+   * whichever is later, to its last needed segment; the frame's bytes, segment 0
+   * included, over that interval are the goodput. A parked frame's interval thus
+   * holds no round trip, and a one-segment frame still gives a sample. Interval
+   * and bytes are smoothed (EWMA). A lost frame, or a smoothed interval above
+   * ABR_DOWN_SHARE of the frame period, steps one layer down at once: on a
+   * hand-off this keeps frames arriving instead of losing them whole. After
+   * ABR_HOLD_FRAMES good frames on a layer, the consumer steps up if the next
+   * layer's frame, at the measured segment size and goodput, would take less
+   * than ABR_UP_SHARE of the frame period.
+   */
+  void
+  adaptLayer(uint64_t frame, const FrameState& st, bool isLost)
+  {
+    if (m_layerSegments.empty() || st.layer != m_layer) {
+      return;   // no layers, or a frame requested before the last switch
+    }
+    if (!isLost && st.firstDataNs > 0 && !m_arrivalLags.empty()) {
+      int64_t available = std::max(static_cast<int64_t>(st.startTimeNs),
+                                   static_cast<int64_t>(frame * periodNs()) + m_arrivalLags.front().second);
+      double fetchNs = static_cast<double>(std::max<int64_t>(0, static_cast<int64_t>(nowNs()) - available));
+      double bytes = static_cast<double>(st.bytesReceived);
+      bool isFirst = m_fetchSamples++ == 0;
+      m_fetchEwmaNs = isFirst ? fetchNs : (1 - ABR_EWMA_WEIGHT) * m_fetchEwmaNs + ABR_EWMA_WEIGHT * fetchNs;
+      m_bytesEwma = isFirst ? bytes : (1 - ABR_EWMA_WEIGHT) * m_bytesEwma + ABR_EWMA_WEIGHT * bytes;
+      if (!st.received.empty()) {
+        m_segmentBytes = bytes / st.received.size();
+      }
+    }
+
+    double period = static_cast<double>(periodNs());
+    if (isLost || m_fetchEwmaNs > ABR_DOWN_SHARE * period) {
+      if (m_layer > 0) {
+        switchLayer(m_layer - 1, isLost ? "frame lost" : "fetch interval");
+      }
+      m_framesOnLayer = 0;
+      return;
+    }
+    if (++m_framesOnLayer < ABR_HOLD_FRAMES || m_layer + 1 >= static_cast<int>(m_layerSegments.size()) ||
+        m_fetchSamples == 0 || m_bytesEwma <= 0) {
+      return;
+    }
+    double nextNs = m_fetchEwmaNs * m_segmentBytes * m_layerSegments[m_layer + 1] / m_bytesEwma;
+    if (nextNs < ABR_UP_SHARE * period) {
+      switchLayer(m_layer + 1, "goodput");
+    }
+  }
+
+  void
+  switchLayer(int layer, const char* reason)
+  {
+    std::cout << "[" << nowNs() << "] ABR: layer " << m_layer << " -> " << layer << " (" << reason
+              << "; goodput_kbps=" << m_bytesEwma * 8e6 / std::max(m_fetchEwmaNs, 1.0)
+              << " fetch_ms=" << m_fetchEwmaNs / 1e6 << ")" << std::endl;
+    m_layer = layer;
+    m_framesOnLayer = 0;
+    // The new layer's fetch interval and frame size are not yet known.
+    m_fetchSamples = 0;
+    m_fetchEwmaNs = 0;
+    m_bytesEwma = 0;
+  }
+
   void
   onNack(const Interest& interest, const lp::Nack& nack)
   {
@@ -366,6 +812,8 @@ private:
   Face m_face;
   ValidatorConfig m_validator;
   Scheduler m_scheduler;
+  SigningMode m_signingMode = SigningMode::ECDSA;
+  std::optional<HmacVerifier> m_hmacVerifier;
 
   Name m_streamPrefix;
   int m_windowFrames = 4;
@@ -376,6 +824,38 @@ private:
   uint64_t m_requestedUpTo = 0;
   std::map<uint64_t, FrameState> m_frames;
 
+  // Frame manifests from verified segment 0s, and manifest-covered segments that
+  // arrived before theirs.
+  struct AwaitingManifest {
+    uint64_t segment = 0;
+    shared_ptr<const Data> data;
+    uint64_t recvTimestamp = 0;
+  };
+  static constexpr uint64_t MANIFEST_RETENTION_MARGIN = 16;
+  std::map<uint64_t, std::vector<name::Component>> m_manifests;
+  std::multimap<uint64_t, AwaitingManifest> m_awaitingManifest;
+
+  // Quality layers: K of each, lightest first, and the adaptation state.
+  static constexpr double ABR_EWMA_WEIGHT = 0.25;
+  static constexpr double ABR_DOWN_SHARE = 0.8;
+  static constexpr double ABR_UP_SHARE = 0.5;
+  static constexpr int ABR_HOLD_FRAMES = 16;
+  static constexpr uint64_t ABR_BASE_FRAMES = 128;
+  std::vector<int> m_layerSegments;
+  int m_layer = 0;
+  int m_framesOnLayer = 0;
+  uint64_t m_fetchSamples = 0;
+  double m_fetchEwmaNs = 0;
+  double m_bytesEwma = 0;        // bytes per frame
+  double m_segmentBytes = 0;
+  // Monotonic deque of (frame, first-arrival lag); the front is the base delay.
+  std::deque<std::pair<uint64_t, int64_t>> m_arrivalLags;
+  time::milliseconds m_framePeriod{20};
+
+  // Segment count of the last frame whose layout was learned, and its parity.
+  int m_lastFrameSegments = 0;
+  int m_lastParity = 0;
+
   // Statistics for experiment analysis
   uint64_t m_framesRequested = 0;
   uint64_t m_framesDelivered = 0;
@@ -384,8 +864,12 @@ private:
   uint64_t m_interestsSent = 0;
   uint64_t m_segmentsReceived = 0;
   uint64_t m_nacks = 0;
+  uint64_t m_fecRecovered = 0;
   uint64_t m_timeouts = 0;
   uint64_t m_discoveries = 0;
+
+  std::unique_ptr<EventLog> m_eventLog;
+  uint32_t m_logPrefixId = EventLog::NO_PREFIX;
 };
 
 } // namespace examples
@@ -0,0 +1,317 @@
+// event-log.hpp
+
+#ifndef OPTOFLOOD_APP_EVENT_LOG_HPP
+#define OPTOFLOOD_APP_EVENT_LOG_HPP
+
+#include <ndn-cxx/name.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ndn {
+namespace examples {
+
+/**
+ * @brief Per-packet events recorded by the producer and the consumer.
+ *
+ * Each value maps to one of the apps' text log lines; the decoder
+ * (experiment/tool/decode_event_log.py) turns records back into that text.
+ * Values are part of the file format: append only.
+ */
+enum class EventType : uint16_t {
+  PREFIX = 1,             ///< defines prefixId: prefix URI packed into frame..d
+  DROPPED = 2,            ///< a: records lost because the ring was full
+  INTEREST_RECEIVED = 3,  ///< producer; a: Interest count, flags: CanBePrefix|MustBeFresh<<1
+  DUPLICATE_IGNORED = 4,  ///< producer
+  MOBILITY_MARKED = 5,    ///< producer; a: FloodId, b: NewFaceSeq
+  DATA_SENT = 6,          ///< producer; a: size, b: Interests, c: Data sent, d: cache hits
+  INTEREST_SENT = 7,      ///< consumer
+  DATA_RECEIVED = 8,      ///< consumer; a: size
+  VALIDATED = 9,          ///< consumer; flags: 0 signature verified, 1 digest matches manifest
+  FRAME_STARTED = 10,     ///< consumer
+  FRAME_DELIVERED = 11,   ///< consumer; a: latency (ns), b: delivered, c: lost, d: skipped
+  INTEREST_REJECTED = 12, ///< producer; flags: reason (0 too far ahead, 1 pending table full)
+};
+
+/**
+ * @brief Fixed-size binary log record. Timestamps are steady_clock nanoseconds;
+ *        the file header pairs them with the system clock for decoding.
+ */
+struct EventRecord
+{
+  uint64_t timeNs;
+  uint16_t type;
+  uint16_t flags;
+  uint32_t prefixId;  ///< stream prefix of the (frame, segment) name, see EventLog::definePrefix
+  uint64_t frame;
+  uint64_t segment;
+  uint64_t a;
+  uint64_t b;
+  uint64_t c;
+  uint64_t d;
+};
+static_assert(sizeof(EventRecord) == 64, "EventRecord layout is part of the file format");
+
+/**
+ * @brief Asynchronous binary event logger.
+ *
+ * Writers copy a 64-byte record into a bounded lock-free ring and return; they
+ * never block, flush or format text, and records that do not fit are counted
+ * and reported as DROPPED. A background thread drains the ring to the file.
+ * Any thread may record (multi-producer, single-consumer ring).
+ *
+ * File layout: 8-byte magic "OFEVLOG1", uint32 record size, uint32 reserved,
+ * int64 steady-clock and int64 system-clock nanoseconds sampled together at
+ * open, then records in host byte order.
+ */
+class EventLog
+{
+public:
+  static constexpr uint32_t NO_PREFIX = 0;
+
+  // Open the log named by EXP_EVENT_LOG; nullptr when unset, in which case the
+  // apps keep their text logging.
+  static std::unique_ptr<EventLog>
+  openFromEnv()
+  {
+    const char* path = std::getenv("EXP_EVENT_LOG");
+    if (path == nullptr || path[0] == '\0') {
+      return nullptr;
+    }
+    return std::make_unique<EventLog>(path);
+  }
+
+  explicit
+  EventLog(const std::string& path, size_t capacity = 1 << 16)
+    : m_slots(roundUpToPowerOfTwo(capacity))
+    , m_mask(m_slots.size() - 1)
+  {
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+      m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    m_file = std::fopen(path.data(), "wb");
+    if (m_file == nullptr) {
+      throw std::runtime_error("Cannot open event log " + path);
+    }
+    int64_t steadyNs = std::chrono::steady_clock::now().time_since_epoch().count();
+    int64_t systemNs = std::chrono::system_clock::now().time_since_epoch().count();
+    uint32_t recordSize = sizeof(EventRecord);
+    uint32_t reserved = 0;
+    std::fwrite("OFEVLOG1", 1, 8, m_file);
+    std::fwrite(&recordSize, sizeof(recordSize), 1, m_file);
+    std::fwrite(&reserved, sizeof(reserved), 1, m_file);
+    std::fwrite(&steadyNs, sizeof(steadyNs), 1, m_file);
+    std::fwrite(&systemNs, sizeof(systemNs), 1, m_file);
+
+    m_drainer = std::thread([this] { drainLoop(); });
+  }
+
+  EventLog(const EventLog&) = delete;
+  EventLog& operator=(const EventLog&) = delete;
+
+  ~EventLog()
+  {
+    m_isStopping.store(true, std::memory_order_release);
+    m_drainer.join();
+    std::fclose(m_file);
+  }
+
+  /**
+   * @brief Register a stream prefix so names <prefix>/<version>/<segment> can be
+   *        logged as (prefixId, frame, segment).
+   *
+   * Must be called before the prefix is used from more than one thread. Returns
+   * NO_PREFIX if the URI does not fit in one PREFIX record.
+   */
+  uint32_t
+  definePrefix(const Name& prefix)
+  {
+    std::string uri = prefix.toUri();
+    EventRecord record{};
+    constexpr size_t maxUri = sizeof(EventRecord) - offsetof(EventRecord, frame);
+    if (uri.size() > maxUri) {
+      return NO_PREFIX;
+    }
+    uint32_t id = static_cast<uint32_t>(m_prefixIds.size() + 1);
+    if (!m_prefixIds.emplace(prefix, id).second) {
+      return m_prefixIds.at(prefix);
+    }
+    record.prefixId = id;
+    std::memcpy(&record.frame, uri.data(), uri.size());
+    write(EventType::PREFIX, record);
+    return id;
+  }
+
+  // The id of the registered prefix that <name> is a (frame, segment) name of.
+  uint32_t
+  findPrefix(const Name& name) const
+  {
+    if (name.size() < 2) {
+      return NO_PREFIX;
+    }
+    auto it = m_prefixIds.find(name.getPrefix(-2));
+    return it == m_prefixIds.end() ? NO_PREFIX : it->second;
+  }
+
+  void
+  record(EventType type, uint32_t prefixId, uint64_t frame, uint64_t segment,
+         uint64_t a = 0, uint64_t b = 0, uint64_t c = 0, uint64_t d = 0,
+         uint16_t flags = 0) noexcept
+  {
+    EventRecord record{};
+    record.flags = flags;
+    record.prefixId = prefixId;
+    record.frame = frame;
+    record.segment = segment;
+    record.a = a;
+    record.b = b;
+    record.c = c;
+    record.d = d;
+    write(type, record);
+  }
+
+  // Record an event about <prefix>/<version=frame>/<segment>. Returns false,
+  // recording nothing, if the name is not under a registered prefix; callers
+  // then fall back to their text line.
+  bool
+  record(EventType type, const Name& name,
+         uint64_t a = 0, uint64_t b = 0, uint64_t c = 0, uint64_t d = 0,
+         uint16_t flags = 0)
+  {
+    uint32_t prefixId = findPrefix(name);
+    if (prefixId == NO_PREFIX || !name.get(-2).isVersion() || !name.get(-1).isSegment()) {
+      return false;
+    }
+    record(type, prefixId, name.get(-2).toVersion(), name.get(-1).toSegment(), a, b, c, d, flags);
+    return true;
+  }
+
+private:
+  struct alignas(64) Slot
+  {
+    std::atomic<size_t> sequence{0};
+    EventRecord record{};
+  };
+
+  static size_t
+  roundUpToPowerOfTwo(size_t n)
+  {
+    size_t size = 2;
+    while (size < n) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  // Bounded MPSC ring (Vyukov): a slot is free for position p when its sequence
+  // equals p, and holds a record for the drainer when it equals p + 1.
+  void
+  write(EventType type, EventRecord& record) noexcept
+  {
+    record.timeNs = std::chrono::steady_clock::now().time_since_epoch().count();
+    record.type = static_cast<uint16_t>(type);
+
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    while (true) {
+      slot = &m_slots[pos & m_mask];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      }
+      else if (diff < 0) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+    slot->record = record;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+  }
+
+  bool
+  read(EventRecord& record) noexcept
+  {
+    Slot& slot = m_slots[m_dequeuePos & m_mask];
+    if (slot.sequence.load(std::memory_order_acquire) != m_dequeuePos + 1) {
+      return false;
+    }
+    record = slot.record;
+    slot.sequence.store(m_dequeuePos + m_slots.size(), std::memory_order_release);
+    m_dequeuePos++;
+    return true;
+  }
+
+  void
+  drainLoop()
+  {
+    static constexpr size_t BATCH = 256;
+    std::vector<EventRecord> batch;
+    batch.reserve(BATCH + 1);
+
+    while (true) {
+      // Read the stop flag first so that records written before it was set are
+      // still drained by the final pass.
+      bool isStopping = m_isStopping.load(std::memory_order_acquire);
+
+      EventRecord record;
+      while (batch.size() < BATCH && read(record)) {
+        batch.push_back(record);
+      }
+      if (uint64_t dropped = m_dropped.exchange(0, std::memory_order_relaxed); dropped > 0) {
+        EventRecord lost{};
+        lost.timeNs = std::chrono::steady_clock::now().time_since_epoch().count();
+        lost.type = static_cast<uint16_t>(EventType::DROPPED);
+        lost.a = dropped;
+        batch.push_back(lost);
+      }
+
+      if (!batch.empty()) {
+        std::fwrite(batch.data(), sizeof(EventRecord), batch.size(), m_file);
+        std::fflush(m_file);
+        bool isFull = batch.size() >= BATCH;
+        batch.clear();
+        if (isFull) {
+          continue;
+        }
+      }
+      if (isStopping) {
+        return;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+private:
+  std::vector<Slot> m_slots;
+  const size_t m_mask;
+  alignas(64) std::atomic<size_t> m_enqueuePos{0};
+  alignas(64) size_t m_dequeuePos = 0;   // drainer thread only
+  std::atomic<uint64_t> m_dropped{0};
+  std::atomic<bool> m_isStopping{false};
+  std::unordered_map<Name, uint32_t> m_prefixIds;
+  std::FILE* m_file = nullptr;
+  std::thread m_drainer;
+};
+
+} // namespace examples
+} // namespace ndn
+
+#endif // OPTOFLOOD_APP_EVENT_LOG_HPP
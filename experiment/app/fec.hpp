@@ -0,0 +1,267 @@
+// fec.hpp
+
+#ifndef OPTOFLOOD_APP_FEC_HPP
+#define OPTOFLOOD_APP_FEC_HPP
+
+#include <ndn-cxx/util/span.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace ndn {
+namespace examples {
+namespace fec {
+
+/**
+ * Forward error correction across the segments of one frame (EXP_FEC_PARITY).
+ *
+ * A frame of K source segments is followed by R parity segments, K..K+R-1, and
+ * FinalBlockId covers all K+R. Every segment of such a frame carries
+ * TLV_FEC_PARITY = R in its MetaInfo; parity segments also carry
+ * TLV_FEC_FRAME_BYTES, the frame's total source bytes, from which the length
+ * of any source segment follows (all are full but the last). Source segments
+ * are zero-padded to the longest one for coding.
+ *
+ * The code is systematic and MDS, so any K of the K+R segments rebuild the
+ * frame: with R = 1 parity is the XOR of the sources; with R > 1 it is
+ * Reed-Solomon over GF(2^8) with Cauchy coefficients 1 / (x_j + y_i), where
+ * y_i = i for source i and x_j = K + j for parity j. Requires K + R <= 256.
+ */
+constexpr uint32_t TLV_FEC_PARITY = 208;
+constexpr uint32_t TLV_FEC_FRAME_BYTES = 209;
+
+constexpr size_t MAX_SEGMENTS = 256;
+
+// GF(2^8) with the polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d).
+class Field
+{
+public:
+  static const Field&
+  get()
+  {
+    static const Field field;
+    return field;
+  }
+
+  uint8_t
+  mul(uint8_t a, uint8_t b) const
+  {
+    return a == 0 || b == 0 ? 0 : m_exp[m_log[a] + m_log[b]];
+  }
+
+  uint8_t
+  inv(uint8_t a) const
+  {
+    if (a == 0) {
+      throw std::domain_error("GF(256): zero has no inverse");
+    }
+    return m_exp[255 - m_log[a]];
+  }
+
+  // out[n] ^= c * in[n] for every byte.
+  void
+  mulAdd(uint8_t* out, const uint8_t* in, size_t size, uint8_t c) const
+  {
+    if (c == 0) {
+      return;
+    }
+    if (c == 1) {
+      for (size_t n = 0; n < size; ++n) {
+        out[n] ^= in[n];
+      }
+      return;
+    }
+    const uint8_t* row = &m_mulTable[c * 256];
+    for (size_t n = 0; n < size; ++n) {
+      out[n] ^= row[in[n]];
+    }
+  }
+
+private:
+  Field()
+    : m_mulTable(256 * 256)
+  {
+    unsigned x = 1;
+    for (int i = 0; i < 255; ++i) {
+      m_exp[i] = static_cast<uint8_t>(x);
+      m_log[x] = static_cast<uint8_t>(i);
+      x <<= 1;
+      if (x & 0x100) {
+        x ^= 0x11d;
+      }
+    }
+    for (int i = 255; i < 512; ++i) {
+      m_exp[i] = m_exp[i - 255];
+    }
+    for (unsigned a = 0; a < 256; ++a) {
+      for (unsigned b = 0; b < 256; ++b) {
+        m_mulTable[a * 256 + b] = mul(static_cast<uint8_t>(a), static_cast<uint8_t>(b));
+      }
+    }
+  }
+
+private:
+  std::array<uint8_t, 512> m_exp{};
+  std::array<uint8_t, 256> m_log{};
+  std::vector<uint8_t> m_mulTable;
+};
+
+// Coefficient of source i in parity j of a frame with K sources and R parities.
+inline uint8_t
+coefficient(size_t sourceCount, size_t parityCount, size_t j, size_t i)
+{
+  if (parityCount == 1) {
+    return 1;
+  }
+  return Field::get().inv(static_cast<uint8_t>((sourceCount + j) ^ i));
+}
+
+inline void
+checkShape(size_t sourceCount, size_t parityCount)
+{
+  if (sourceCount == 0 || sourceCount + parityCount > MAX_SEGMENTS) {
+    throw std::invalid_argument("FEC needs 1 <= K and K + R <= 256");
+  }
+}
+
+/**
+ * @brief Compute parity segment j over the K source segments of a frame.
+ * @return parity bytes, as long as the longest source segment
+ */
+inline std::vector<uint8_t>
+encodeParity(const std::vector<span<const uint8_t>>& sources, size_t parityCount, size_t j)
+{
+  checkShape(sources.size(), parityCount);
+  if (j >= parityCount) {
+    throw std::invalid_argument("FEC parity index out of range");
+  }
+  size_t size = 0;
+  for (const auto& source : sources) {
+    size = std::max(size, source.size());
+  }
+  std::vector<uint8_t> parity(size, 0);
+  const Field& field = Field::get();
+  for (size_t i = 0; i < sources.size(); ++i) {
+    field.mulAdd(parity.data(), sources[i].data(), sources[i].size(),
+                 coefficient(sources.size(), parityCount, j, i));
+  }
+  return parity;
+}
+
+// Length of source segment i in a frame of frameBytes split into segments of
+// segmentBytes (all full but the last).
+inline size_t
+sourceLength(size_t frameBytes, size_t segmentBytes, size_t i)
+{
+  size_t offset = i * segmentBytes;
+  return offset < frameBytes ? std::min(segmentBytes, frameBytes - offset) : 0;
+}
+
+/**
+ * @brief Rebuild missing source segments of a frame from any K received ones.
+ *
+ * @param segments  K + R entries indexed by segment number, holding the content
+ *                  of those that arrived
+ * @param isReceived which of the K + R segments arrived
+ * @param sourceCount K
+ * @param frameBytes total source bytes, from TLV_FEC_FRAME_BYTES
+ * @return false if fewer than K segments arrived; otherwise every missing
+ *         source entry of @p segments is filled in
+ */
+inline bool
+recover(std::vector<std::vector<uint8_t>>& segments, const std::vector<bool>& isReceived,
+        size_t sourceCount, size_t frameBytes)
+{
+  size_t parityCount = segments.size() - sourceCount;
+  checkShape(sourceCount, parityCount);
+
+  std::vector<size_t> missing;
+  std::vector<size_t> parities;
+  size_t size = 0;
+  for (size_t n = 0; n < segments.size(); ++n) {
+    if (!isReceived[n]) {
+      if (n < sourceCount) {
+        missing.push_back(n);
+      }
+      continue;
+    }
+    size = std::max(size, segments[n].size());
+    if (n >= sourceCount) {
+      parities.push_back(n - sourceCount);
+    }
+  }
+  if (missing.empty()) {
+    return true;
+  }
+  if (parities.size() < missing.size()) {
+    return false;
+  }
+  parities.resize(missing.size());
+
+  const Field& field = Field::get();
+  size_t m = missing.size();
+  // Right-hand sides: each used parity minus the contribution of the sources
+  // that did arrive.
+  std::vector<std::vector<uint8_t>> rhs(m);
+  for (size_t r = 0; r < m; ++r) {
+    size_t j = parities[r];
+    rhs[r] = segments[sourceCount + j];
+    rhs[r].resize(size, 0);
+    for (size_t i = 0; i < sourceCount; ++i) {
+      if (isReceived[i]) {
+        field.mulAdd(rhs[r].data(), segments[i].data(), segments[i].size(),
+                     coefficient(sourceCount, parityCount, j, i));
+      }
+    }
+  }
+
+  // Solve A x = rhs over the missing sources by Gauss-Jordan elimination; A is
+  // a square submatrix of the coding matrix, hence invertible.
+  std::vector<std::vector<uint8_t>> a(m, std::vector<uint8_t>(m));
+  for (size_t r = 0; r < m; ++r) {
+    for (size_t c = 0; c < m; ++c) {
+      a[r][c] = coefficient(sourceCount, parityCount, parities[r], missing[c]);
+    }
+  }
+  for (size_t c = 0; c < m; ++c) {
+    size_t pivot = c;
+    while (a[pivot][c] == 0) {
+      ++pivot;
+    }
+    std::swap(a[pivot], a[c]);
+    std::swap(rhs[pivot], rhs[c]);
+    uint8_t scale = field.inv(a[c][c]);
+    for (size_t k = 0; k < m; ++k) {
+      a[c][k] = field.mul(a[c][k], scale);
+    }
+    std::vector<uint8_t> scaled(size, 0);
+    field.mulAdd(scaled.data(), rhs[c].data(), size, scale);
+    rhs[c] = std::move(scaled);
+    for (size_t r = 0; r < m; ++r) {
+      if (r != c && a[r][c] != 0) {
+        uint8_t factor = a[r][c];
+        for (size_t k = 0; k < m; ++k) {
+          a[r][k] ^= field.mul(factor, a[c][k]);
+        }
+        field.mulAdd(rhs[r].data(), rhs[c].data(), size, factor);
+      }
+    }
+  }
+
+  size_t segmentBytes = size;
+  for (size_t c = 0; c < m; ++c) {
+    rhs[c].resize(sourceLength(frameBytes, segmentBytes, missing[c]));
+    segments[missing[c]] = std::move(rhs[c]);
+  }
+  return true;
+}
+
+} // namespace fec
+} // namespace examples
+} // namespace ndn
+
+#endif // OPTOFLOOD_APP_FEC_HPP
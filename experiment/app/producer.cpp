@@ -6,23 +6,59 @@
 #include <ndn-cxx/meta-info.hpp>
 #include <ndn-cxx/encoding/block.hpp>
 #include <ndn-cxx/encoding/block-helpers.hpp>
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
 #include <ndn-cxx/encoding/tlv.hpp>
+#include <ndn-cxx/lp/tags.hpp>
+#include <ndn-cxx/mgmt/control-response.hpp>
+#include <ndn-cxx/mgmt/nfd/control-parameters.hpp>
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+#include <ndn-cxx/security/interest-signer.hpp>
+#include <ndn-cxx/security/verification-helpers.hpp>
 #include <ndn-cxx/util/scheduler.hpp>
+#include <ndn-cxx/util/sha256.hpp>
+#include <ndn-cxx/util/span.hpp>
 
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <string_view>
-#include <cstdlib> // For std::system
+#include <cstdlib> // For std::getenv
 #include <cstring> // For strerror
 #include <cerrno>  // For errno
+#include <cctype>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
 #include <chrono>
 #include <thread>
 #include <iomanip>
-#include <deque>
+#include <functional>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <set>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
+
+#include "event-log.hpp"
+#include "fec.hpp"
+#include "signing-mode.hpp"
 
 // Only available in solution build
 #ifdef SOLUTION_ENABLED
@@ -34,6 +70,11 @@
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 // OptoFlood TLV types are now defined in ndn-cxx/optoflood.hpp
 
@@ -46,14 +87,47 @@ namespace examples {
 // live edge via feedback, with no shared clock. Must match the consumer.
 constexpr uint32_t TLV_LIVE_EDGE = 206;
 
+// Application-level TLV type carrying a frame manifest in the MetaInfo of
+// segment 0: the implicit SHA-256 digests of segments 1..K-1, in order. Those
+// segments then only carry a DigestSha256 signature. Must match the consumer.
+constexpr uint32_t TLV_FRAME_MANIFEST = 207;
+
+// Manifest size: each entry is an ImplicitSha256DigestComponent (2-byte header,
+// 32-byte digest), and the manifest TLV header takes at most 4 bytes.
+constexpr size_t MANIFEST_ENTRY_BYTES = 34;
+constexpr size_t MANIFEST_HEADER_BYTES = 4;
+
+// Content of every reply when no payload source is configured.
+constexpr std::string_view MARKER_CONTENT = "OptoFlood Test Data";
+
+// Largest payload per segment: keeps a signed Data with its name and MetaInfo
+// below ndn-cxx's MAX_NDN_PACKET_SIZE (8800 bytes).
+constexpr size_t MAX_SEGMENT_BYTES = 8000;
+
 // Generic name component that marks a live-edge discovery Interest
 // (<stream>/_meta). Must match the consumer.
 constexpr char DISCOVERY_MARKER[] = "_meta";
 
+// Generic name component of the flood-marked announcement a producer sends on
+// a mobility event (<stream>/_mobility/<seq=event>). Nobody requests it.
+constexpr char MOBILITY_MARKER[] = "_mobility";
+
+// Generic name component of the statistics endpoint (<stream>/_stats), answered
+// with the producer's metrics in OpenMetrics text format.
+constexpr char STATS_MARKER[] = "_stats";
+
 /**
  * @brief A helper class to listen for network interface changes using Netlink.
  * This class encapsulates the logic for creating a Netlink socket and integrating
  * it with the ndn-cxx/boost::asio event loop.
+ *
+ * A link trigger fires when an interface becomes up and running, not on every
+ * RTM_NEWLINK that reports it so; address and route triggers are optional and
+ * likewise fire only for an address or route not already known. Triggers are
+ * debounced per interface. Nothing here blocks the event loop: socket errors
+ * are retried from a timer, and events lost to a receive-buffer overflow
+ * (ENOBUFS) are recovered by re-dumping the link table and, when their
+ * triggers are on, the address and route tables.
  */
 class NetlinkListener : noncopyable
 {
@@ -61,25 +135,49 @@ public:
   // The callback will be invoked when a mobility event is detected.
   using MobilityCallback = std::function<void()>;
 
-  NetlinkListener(boost::asio::io_context& io, MobilityCallback callback)
+  struct Options
+  {
+    bool onLink = true;      ///< interface became up and running (RTM_NEWLINK)
+    bool onAddress = false;  ///< address added to an interface (RTM_NEWADDR)
+    bool onRoute = false;    ///< main-table route added (RTM_NEWROUTE)
+    // Further triggers on the same interface within this window are ignored.
+    std::chrono::milliseconds debounce{250};
+  };
+
+  NetlinkListener(boost::asio::io_context& io, MobilityCallback callback, const Options& options)
     : m_ioService(io)
     , m_callback(callback)
+    , m_options(options)
     , m_netlinkSocket(io)
+    , m_retryTimer(io)
   {
   }
 
   void
   start()
   {
-    int sock = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+    int sock = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
     if (sock < 0) {
       throw std::runtime_error("Failed to create Netlink socket");
     }
 
+    // A handoff can emit a burst of link, address and route messages; a larger
+    // buffer makes overflow unlikely. SO_RCVBUFFORCE lifts rmem_max when root.
+    int rcvbuf = RECEIVE_BUFFER_BYTES;
+    if (setsockopt(sock, SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf)) < 0) {
+      setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+
     struct sockaddr_nl sa;
     memset(&sa, 0, sizeof(sa));
     sa.nl_family = AF_NETLINK;
     sa.nl_groups = RTMGRP_LINK;
+    if (m_options.onAddress) {
+      sa.nl_groups |= RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+    }
+    if (m_options.onRoute) {
+      sa.nl_groups |= RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+    }
 
     if (bind(sock, (struct sockaddr*)&sa, sizeof(sa)) < 0) {
       close(sock);
@@ -87,10 +185,25 @@ public:
     }
 
     m_netlinkSocket.assign(sock);
+    // Learn which interfaces, addresses and routes already exist, so they do not
+    // count as new.
+    m_isInitialSync = true;
+    resynchronize();
     waitForEvent();
   }
 
 private:
+  struct InterfaceState
+  {
+    bool isRunning = false;
+    std::chrono::steady_clock::time_point lastTrigger;
+  };
+
+  // Known addresses and main-table routes, each keyed by its interface and
+  // identifying bytes, mapped to the sequence number of the last dump at the
+  // time it was seen; a dump drops the entries it no longer reports.
+  using KnownSet = std::map<std::string, uint32_t>;
+
   void
   waitForEvent()
   {
@@ -99,412 +212,3483 @@ private:
                               bind(&NetlinkListener::handleEvent, this, _1));
   }
 
+  // Restart monitoring after a delay, without stalling the event loop.
   void
-  handleEvent(const boost::system::error_code& error)
+  retryLater()
   {
-    if (error) {
-      std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count() 
-                << "] ERROR: Netlink socket error: " << error.message() 
-                << " (code: " << error.value() << ")" << std::endl;
-      
-      if (error == boost::asio::error::operation_aborted) {
-        std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count() 
-                  << "] INFO: Netlink listener shutting down gracefully" << std::endl;
-        return;
+    std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+              << "] INFO: Attempting to restart Netlink monitoring in 1 second" << std::endl;
+    m_retryTimer.expires_after(std::chrono::seconds(1));
+    m_retryTimer.async_wait([this] (const boost::system::error_code& error) {
+      if (!error) {
+        waitForEvent();
       }
-      
-      // For other errors, try to restart monitoring after a delay
-      std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count() 
-                << "] INFO: Attempting to restart Netlink monitoring in 1 second" << std::endl;
-      std::this_thread::sleep_for(std::chrono::seconds(1));
-      waitForEvent();
+    });
+  }
+
+  // Queue a dump of every table a trigger depends on. The kernel runs one dump
+  // per socket at a time, so they are requested in turn as each one ends.
+  void
+  resynchronize()
+  {
+    m_pendingDumps = {RTM_GETLINK};
+    if (m_options.onAddress) {
+      m_pendingDumps.push_back(RTM_GETADDR);
+    }
+    if (m_options.onRoute) {
+      m_pendingDumps.push_back(RTM_GETROUTE);
+    }
+    if (!m_isDumping) {
+      requestNextDump();
+    }
+  }
+
+  // Ask the kernel for the next queued table; the replies arrive as RTM_NEW*
+  // messages and are processed like notifications, ending with NLMSG_DONE.
+  void
+  requestNextDump()
+  {
+    if (m_pendingDumps.empty()) {
+      m_isInitialSync = false;
       return;
     }
+    uint16_t type = m_pendingDumps.front();
+    m_pendingDumps.erase(m_pendingDumps.begin());
 
-    char buf[8192];
-    struct iovec iov = { buf, sizeof(buf) };
-    struct sockaddr_nl sa;
-    struct msghdr msg = { &sa, sizeof(sa), &iov, 1, nullptr, 0, 0 };
+    // Every body starts with its address family, left at AF_UNSPEC for all.
+    struct {
+      struct nlmsghdr header;
+      union {
+        struct ifinfomsg link;
+        struct ifaddrmsg address;
+        struct rtmsg route;
+      } body;
+    } request;
+    memset(&request, 0, sizeof(request));
+    size_t bodySize = type == RTM_GETLINK ? sizeof(struct ifinfomsg) :
+                      type == RTM_GETADDR ? sizeof(struct ifaddrmsg) : sizeof(struct rtmsg);
+    request.header.nlmsg_len = NLMSG_LENGTH(bodySize);
+    request.header.nlmsg_type = type;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = ++m_dumpSeq;
 
-    ssize_t len = recvmsg(m_netlinkSocket.native_handle(), &msg, 0);
-    if (len < 0) {
+    if (send(m_netlinkSocket.native_handle(), &request, request.header.nlmsg_len, 0) < 0) {
       int err = errno;
-      std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count() 
-                << "] ERROR: Netlink recvmsg failed: " << strerror(err) 
+      std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                << "] ERROR: Netlink dump request failed: " << strerror(err)
                 << " (errno: " << err << ")" << std::endl;
-      
-      // Handle specific error cases
-      if (err == EAGAIN || err == EWOULDBLOCK) {
-        // No data available, continue waiting
-        waitForEvent();
-      } else if (err == ENOBUFS) {
-        // Buffer overflow, log and continue
-        std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count() 
-                  << "] WARNING: Netlink buffer overflow, some events may be lost" << std::endl;
-        waitForEvent();
+      m_pendingDumps.clear();
+      m_isInitialSync = false;
+      return;
+    }
+    m_isDumping = true;
+    m_dumpType = type;
+  }
+
+  // A dump has ended: forget what it no longer reports, then start the next.
+  void
+  onDumpDone()
+  {
+    m_isDumping = false;
+    if (m_dumpType == RTM_GETADDR) {
+      sweep(m_addresses);
+    }
+    else if (m_dumpType == RTM_GETROUTE) {
+      sweep(m_routes);
+    }
+    requestNextDump();
+  }
+
+  void
+  sweep(KnownSet& known)
+  {
+    for (auto it = known.begin(); it != known.end(); ) {
+      it = it->second == m_dumpSeq ? std::next(it) : known.erase(it);
+    }
+  }
+
+  void
+  handleEvent(const boost::system::error_code& error)
+  {
+    if (error) {
+      std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                << "] ERROR: Netlink socket error: " << error.message()
+                << " (code: " << error.value() << ")" << std::endl;
+
+      if (error == boost::asio::error::operation_aborted) {
+        std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                  << "] INFO: Netlink listener shutting down gracefully" << std::endl;
+        return;
       }
+      retryLater();
       return;
     }
 
-    for (struct nlmsghdr* nlh = (struct nlmsghdr*)buf; NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
-      if (nlh->nlmsg_type == RTM_NEWLINK) {
-        struct ifinfomsg* ifi = (struct ifinfomsg*)NLMSG_DATA(nlh);
-        // Check if the interface is up and running. This is our mobility trigger.
-        if ((ifi->ifi_flags & IFF_UP) && (ifi->ifi_flags & IFF_RUNNING)) {
-          struct rtattr* rta = IFLA_RTA(ifi);
-          int rta_len = nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifi));
-          for (; RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
-            if (rta->rta_type == IFLA_IFNAME) {
-                std::string ifname(static_cast<char*>(RTA_DATA(rta)));
-                auto now = std::chrono::system_clock::now();
-                auto timestamp = now.time_since_epoch().count();
-                
-                std::cout << "[" << timestamp << "] MOBILITY: Interface state change detected" << std::endl;
-                std::cout << "[" << timestamp << "] MOBILITY: Interface '" << ifname 
-                          << "' is UP (flags: 0x" << std::hex << ifi->ifi_flags << std::dec << ")" << std::endl;
-                std::cout << "[" << timestamp << "] MOBILITY: Triggering mobility event handler" << std::endl;
-                
-                m_callback();
-                break;
-            }
-          }
+    // Drain every queued message before waiting again.
+    while (true) {
+      struct iovec iov = { m_buffer.data(), m_buffer.size() };
+      struct sockaddr_nl sa;
+      struct msghdr msg = { &sa, sizeof(sa), &iov, 1, nullptr, 0, 0 };
+
+      ssize_t len = recvmsg(m_netlinkSocket.native_handle(), &msg, 0);
+      if (len < 0) {
+        int err = errno;
+        if (err == EAGAIN || err == EWOULDBLOCK) {
+          // No data available, continue waiting
+          break;
+        }
+        if (err == EINTR) {
+          continue;
         }
+        if (err == ENOBUFS) {
+          // Notifications were dropped; the tables are re-read instead. A dump in
+          // progress may have lost replies too, so the full set runs after it.
+          std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                    << "] WARNING: Netlink buffer overflow, resynchronizing link, address and route state"
+                    << std::endl;
+          resynchronize();
+          continue;
+        }
+        std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                  << "] ERROR: Netlink recvmsg failed: " << strerror(err)
+                  << " (errno: " << err << ")" << std::endl;
+        retryLater();
+        return;
       }
+      processMessages(len);
     }
     // Reschedule the wait for the next event
     waitForEvent();
   }
 
-private:
-  boost::asio::io_context& m_ioService;
-  MobilityCallback m_callback;
-  boost::asio::posix::stream_descriptor m_netlinkSocket;
-};
-
-
-class Producer : noncopyable
-{
-public:
-  Producer()
-    : m_face(m_ioContext)
-    , m_scheduler(m_ioContext)
-    , m_keyChain()
+  void
+  processMessages(ssize_t len)
   {
-    // Frame production period: a new frame becomes available every m_interval,
-    // supplied by the driver via EXP_REQUEST_INTERVAL_MS (20 ms safety-net default).
-    const char* rawInterval = std::getenv("EXP_REQUEST_INTERVAL_MS");
-    int intervalMs = rawInterval ? std::atoi(rawInterval) : 20;
-    if (intervalMs <= 0) {
-      intervalMs = 20;
+    for (struct nlmsghdr* nlh = (struct nlmsghdr*)m_buffer.data(); NLMSG_OK(nlh, len); nlh = NLMSG_NEXT(nlh, len)) {
+      switch (nlh->nlmsg_type) {
+        case NLMSG_DONE:
+        case NLMSG_ERROR:
+          if (m_isDumping && nlh->nlmsg_seq == m_dumpSeq) {
+            onDumpDone();
+          }
+          break;
+        case RTM_NEWLINK:
+        case RTM_DELLINK:
+          onLinkMessage(nlh);
+          break;
+        case RTM_NEWADDR:
+        case RTM_DELADDR:
+          if (m_options.onAddress) {
+            onAddressMessage(nlh);
+          }
+          break;
+        case RTM_NEWROUTE:
+        case RTM_DELROUTE:
+          if (m_options.onRoute) {
+            onRouteMessage(nlh);
+          }
+          break;
+      }
     }
-    m_interval = time::milliseconds(intervalMs);
+  }
 
-    // Segments per frame (K). FinalBlockId on every segment advertises K-1 so the
-    // consumer can fetch all segments. Supplied via EXP_SEGMENTS_PER_FRAME (default 1).
-    const char* rawSegments = std::getenv("EXP_SEGMENTS_PER_FRAME");
-    m_segmentsPerFrame = rawSegments ? std::atoi(rawSegments) : 1;
-    if (m_segmentsPerFrame <= 0) {
-      m_segmentsPerFrame = 1;
+  void
+  onLinkMessage(struct nlmsghdr* nlh)
+  {
+    struct ifinfomsg* ifi = (struct ifinfomsg*)NLMSG_DATA(nlh);
+    // Check if the interface is up and running. This is our mobility trigger.
+    bool isRunning = nlh->nlmsg_type == RTM_NEWLINK &&
+                     (ifi->ifi_flags & IFF_UP) && (ifi->ifi_flags & IFF_RUNNING);
+    auto& state = m_interfaces[ifi->ifi_index];
+    bool hasComeUp = isRunning && !state.isRunning;
+    state.isRunning = isRunning;
+    if (!hasComeUp || m_isInitialSync || !m_options.onLink) {
+      return;
     }
 
-    // Default to disabled; enable automatically in solution builds
-#ifdef SOLUTION_ENABLED
-    m_enableOptoFlood = true;
-#endif
+    std::string ifname;
+    struct rtattr* rta = IFLA_RTA(ifi);
+    int rta_len = nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifi));
+    for (; RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
+      if (rta->rta_type == IFLA_IFNAME) {
+        ifname = static_cast<char*>(RTA_DATA(rta));
+        break;
+      }
+    }
+    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    std::cout << "[" << timestamp << "] MOBILITY: Interface state change detected" << std::endl;
+    std::cout << "[" << timestamp << "] MOBILITY: Interface '" << ifname
+              << "' is UP (flags: 0x" << std::hex << ifi->ifi_flags << std::dec << ")" << std::endl;
+    trigger(ifi->ifi_index, "link up");
   }
 
-  void enableOptoFlood(bool enable = true) { m_enableOptoFlood = enable; }
-  void forceMobilityOnce() { m_enableOptoFlood = true; m_forceMobilityOnceFlag = true; }
-
   void
-  run()
+  onAddressMessage(struct nlmsghdr* nlh)
   {
-    // Register prefix with a success callback to advertise it via NLSR
-    m_face.setInterestFilter("/LiveStream",
-                             std::bind(&Producer::onInterest, this, _2),
-                             std::bind(&Producer::onRegisterSuccess, this, _1),
-                             std::bind(&Producer::onRegisterFailed, this, _1, _2));
-    if (m_enableOptoFlood) {
-    try {
-        if (!m_netlinkListener) {
-          m_netlinkListener = std::make_unique<NetlinkListener>(
-            m_ioContext, [this] { this->onMobilityEvent(); }
-          );
-        }
-      m_netlinkListener->start();
-      std::cout << "Netlink listener started for mobility detection." << std::endl;
-    }
-    catch (const std::exception& e) {
-      std::cerr << "ERROR: Failed to start Netlink listener: " << e.what() << std::endl;
+    auto* ifa = (struct ifaddrmsg*)NLMSG_DATA(nlh);
+    int ifindex = static_cast<int>(ifa->ifa_index);
+    std::string key = keyPrefix(ifindex, ifa->ifa_family, ifa->ifa_prefixlen);
+    struct rtattr* rta = IFA_RTA(ifa);
+    int rta_len = IFA_PAYLOAD(nlh);
+    for (; RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
+      if (rta->rta_type == IFA_ADDRESS) {
+        key.append(static_cast<const char*>(RTA_DATA(rta)), RTA_PAYLOAD(rta));
+      }
     }
+    if (update(m_addresses, key, nlh->nlmsg_type == RTM_NEWADDR)) {
+      trigger(ifindex, "address added");
     }
-    m_startTime = time::steady_clock::now();
-    scheduleDataSend();
-    m_ioContext.run();
   }
 
-private:
   void
-  onRegisterSuccess(const Name& prefix)
+  onRouteMessage(struct nlmsghdr* nlh)
   {
-    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
-    std::cout << "[" << timestamp << "] PREFIX: Successfully registered prefix: " << prefix << std::endl;
-    
-    // Now that the local filter is confirmed, advertise the prefix to the network.
-    std::cout << "[" << timestamp << "] PREFIX: Advertising prefix via NLSR" << std::endl;
-    int ret = std::system("nlsrc advertise /LiveStream");
-    if (ret != 0) {
-      std::cerr << "[" << timestamp << "] ERROR: Failed to advertise prefix with nlsrc (exit code: " 
-                << ret << ")" << std::endl;
-      m_face.shutdown();
-    } else {
-      std::cout << "[" << timestamp << "] PREFIX: Successfully advertised prefix via NLSR" << std::endl;
+    auto* rtm = (struct rtmsg*)NLMSG_DATA(nlh);
+    if (rtm->rtm_table != RT_TABLE_MAIN) {
+      return;
+    }
+    // A multipath route has no RTA_OIF; it is filed under its first next hop.
+    int ifindex = 0;
+    std::string destination;
+    std::string gateway;
+    struct rtattr* rta = RTM_RTA(rtm);
+    int rta_len = RTM_PAYLOAD(nlh);
+    for (; RTA_OK(rta, rta_len); rta = RTA_NEXT(rta, rta_len)) {
+      if (rta->rta_type == RTA_OIF) {
+        ifindex = *static_cast<int*>(RTA_DATA(rta));
+      }
+      else if (rta->rta_type == RTA_MULTIPATH && ifindex == 0 && RTA_PAYLOAD(rta) >= sizeof(struct rtnexthop)) {
+        ifindex = static_cast<struct rtnexthop*>(RTA_DATA(rta))->rtnh_ifindex;
+      }
+      else if (rta->rta_type == RTA_DST) {
+        destination.assign(static_cast<const char*>(RTA_DATA(rta)), RTA_PAYLOAD(rta));
+      }
+      else if (rta->rta_type == RTA_GATEWAY) {
+        gateway.assign(static_cast<const char*>(RTA_DATA(rta)), RTA_PAYLOAD(rta));
+      }
+    }
+    std::string key = keyPrefix(ifindex, rtm->rtm_family, rtm->rtm_dst_len) + destination + '/' + gateway;
+    if (update(m_routes, key, nlh->nlmsg_type == RTM_NEWROUTE)) {
+      trigger(ifindex, "route added");
     }
   }
 
-  void
-  onRegisterFailed(const Name& prefix, const std::string& reason)
+  static std::string
+  keyPrefix(int ifindex, unsigned char family, unsigned char prefixLength)
   {
-    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
-    std::cerr << "[" << timestamp << "] ERROR: Failed to register prefix '" << prefix 
-              << "' with reason: " << reason << std::endl;
-    std::cerr << "[" << timestamp << "] ERROR: Shutting down face due to registration failure" << std::endl;
-    m_face.shutdown();
+    return std::to_string(ifindex) + '/' + std::to_string(family) + '/' + std::to_string(prefixLength) + '/';
   }
 
-  // This callback is triggered by the NetlinkListener
-  void
-  onMobilityEvent()
+  // Record an entry as present or gone; true if it is new and should trigger.
+  bool
+  update(KnownSet& known, const std::string& key, bool isPresent)
   {
-    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
-    std::cout << "[" << timestamp << "] MOBILITY: Producer mobility event triggered" << std::endl;
-    m_mobilityEventCount++;
-    for (auto& pending : m_pendingInterests) {
-      pending.markMobility = true;
-      pending.mobilitySeq = m_mobilityEventCount;
+    if (!isPresent) {
+      known.erase(key);
+      return false;
     }
-    std::cout << "[" << timestamp << "] MOBILITY: Total mobility events: " << m_mobilityEventCount << std::endl;
-    std::cout << "[" << timestamp << "] MOBILITY: Pending Interests marked: " << m_pendingInterests.size() << std::endl;
+    bool isNew = known.insert_or_assign(key, m_dumpSeq).second;
+    return isNew && !m_isInitialSync;
   }
 
   void
-  scheduleDataSend()
+  trigger(int ifindex, const char* reason)
   {
-    m_scheduler.schedule(m_interval, [this] { this->advanceLiveEdgeAndServe(); });
+    auto now = std::chrono::steady_clock::now();
+    auto& state = m_interfaces[ifindex];
+    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    if (state.lastTrigger != std::chrono::steady_clock::time_point{} &&
+        now - state.lastTrigger < m_options.debounce) {
+      std::cout << "[" << timestamp << "] MOBILITY: Ignoring " << reason
+                << " on interface " << ifindex << " within debounce window" << std::endl;
+      return;
+    }
+    state.lastTrigger = now;
+    std::cout << "[" << timestamp << "] MOBILITY: Triggering mobility event handler ("
+              << reason << ", interface " << ifindex << ")" << std::endl;
+    m_callback();
   }
 
-  // Encode and send one Data packet for a requested (frame, segment). Every Data
-  // carries the current live edge (TLV_LIVE_EDGE) so consumers track it via
-  // feedback. Mobility-marked Data additionally carry OptoFlood markers so the
-  // modified forwarder floods them along the FIB to refresh the path.
-  void
-  serveOne(const Name& name, bool markMobility, uint32_t mobilitySeq,
-           time::milliseconds freshness = 10_s)
-  {
-    auto data = make_shared<Data>(name);
-    data->setFreshnessPeriod(freshness);
-    // FinalBlockId advertises the last segment index (K-1) of the frame.
-    data->setFinalBlock(name::Component::fromSegment(m_segmentsPerFrame - 1));
-    data->setContent(std::string_view("OptoFlood Test Data"));
-
-    MetaInfo metaInfo = data->getMetaInfo();
-    metaInfo.addAppMetaInfo(makeNonNegativeIntegerBlock(TLV_LIVE_EDGE, edgeNow()));
-#ifdef SOLUTION_ENABLED
-    if (m_enableOptoFlood && markMobility) {
-      uint64_t floodId = ++m_floodIdSeq;
-      metaInfo.addAppMetaInfo(optoflood::makeFloodIdBlock(floodId));
-      metaInfo.addAppMetaInfo(optoflood::makeNewFaceSeqBlock(mobilitySeq));
-      std::cout << "[" << std::chrono::system_clock::now().time_since_epoch().count()
-                << "] DATA: Attaching OptoFlood mobility markers"
-                << " NewFaceSeq: " << mobilitySeq
-                << " FloodId: " << floodId << std::endl;
-    }
-#endif
-    data->setMetaInfo(metaInfo);
+private:
+  static constexpr int RECEIVE_BUFFER_BYTES = 1 << 20;
 
-    m_keyChain.sign(*data);
+  boost::asio::io_context& m_ioService;
+  MobilityCallback m_callback;
+  Options m_options;
+  boost::asio::posix::stream_descriptor m_netlinkSocket;
+  boost::asio::steady_timer m_retryTimer;
+  alignas(struct nlmsghdr) std::array<char, 32768> m_buffer;
+  std::unordered_map<int, InterfaceState> m_interfaces;
+  KnownSet m_addresses;
+  KnownSet m_routes;
+  std::vector<uint16_t> m_pendingDumps;
+  uint16_t m_dumpType = 0;
+  uint32_t m_dumpSeq = 0;
+  bool m_isDumping = false;
+  bool m_isInitialSync = false;
+};
 
-    auto sendTimestamp = std::chrono::system_clock::now().time_since_epoch().count();
-    std::cout << "[" << sendTimestamp << "] DATA: Sending response"
-              << " Size: " << data->wireEncode().size() << " bytes"
-              << " Name: " << data->getName() << std::endl;
+/**
+ * @brief Issues NLSR prefix-update commands (advertise, withdraw) as signed
+ *        command Interests on the producer's own Face.
+ *
+ * Replaces forking `nlsrc`: commands are asynchronous, so the event loop never
+ * waits for NLSR, and are retried with exponential backoff on timeout or Nack.
+ * The command format is that of nlsrc:
+ * /localhost/nlsr/prefix-update/<verb>/<ControlParameters>, signed with the
+ * default identity, answered by a ControlResponse.
+ */
+class NlsrPrefixControl : noncopyable
+{
+public:
+  using DoneCallback = std::function<void(bool isSuccess)>;
 
-    m_face.put(*data);
-    m_dataCount++;
+  NlsrPrefixControl(Face& face, KeyChain& keyChain, Scheduler& scheduler, int maxRetries)
+    : m_face(face)
+    , m_signer(keyChain)
+    , m_scheduler(scheduler)
+    , m_maxRetries(maxRetries)
+  {
+  }
 
-    std::cout << "[" << sendTimestamp << "] STATS: Total Interests: " << m_interestCount
-              << " Total Data sent: " << m_dataCount << std::endl;
+  void
+  advertise(const Name& prefix, DoneCallback done = nullptr)
+  {
+    send("advertise", prefix, 0, std::move(done));
   }
 
-  // The live edge advances by the producer's own wall-clock: frame N becomes
-  // available at m_startTime + N*framePeriod. Computed on demand, independent of
-  // per-tick processing time, and requires no cross-node clock synchronisation.
-  uint64_t
-  edgeNow() const
+  void
+  withdraw(const Name& prefix, DoneCallback done = nullptr)
   {
-    auto elapsed = time::steady_clock::now() - m_startTime;
-    if (elapsed.count() <= 0) {
-      return 0;
-    }
-    return static_cast<uint64_t>(elapsed / m_interval);
+    send("withdraw", prefix, 0, std::move(done));
   }
 
-  // Periodic tick: serve every parked Interest whose frame has now been produced
-  // (frame <= edgeNow()). Mobility-marked Interests carry OptoFlood markers.
+  /**
+   * @brief Advertise an already announced prefix again, which NLSR takes as a
+   *        refresh of its name LSA.
+   *
+   * No withdraw precedes it: that would push a route withdrawal through the
+   * network in the middle of the handoff the refresh is meant to shorten.
+   */
   void
-  advanceLiveEdgeAndServe()
+  readvertise(const Name& prefix, DoneCallback done = nullptr)
   {
-    uint64_t edge = edgeNow();
+    advertise(prefix, std::move(done));
+  }
 
-    auto now = time::steady_clock::now();
+private:
+  void
+  send(const char* verb, const Name& prefix, int attempt, DoneCallback done)
+  {
+    nfd::ControlParameters parameters;
+    parameters.setName(prefix);
+    Name command("/localhost/nlsr/prefix-update");
+    command.append(verb).append(parameters.wireEncode());
+    Interest interest = m_signer.makeCommandInterest(command);
+    interest.setMustBeFresh(true);
+    interest.setInterestLifetime(COMMAND_LIFETIME);
 
-    // Drop parked Interests whose lifetime has elapsed: the network PIT entry is
-    // gone, so any Data produced now would be unsolicited.
-    for (auto it = m_pendingInterests.begin(); it != m_pendingInterests.end(); ) {
-      if (now > it->expiry) {
-        m_pendingNames.erase(it->name);
-        it = m_pendingInterests.erase(it);
+    auto retry = [this, verb, prefix, attempt, done] (const std::string& reason) {
+      auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+      if (attempt >= m_maxRetries) {
+        std::cerr << "[" << timestamp << "] ERROR: NLSR " << verb << " " << prefix
+                  << " failed after " << attempt + 1 << " attempts: " << reason << std::endl;
+        if (done) {
+          done(false);
+        }
+        return;
       }
-      else {
-        ++it;
+      auto delay = RETRY_BASE_DELAY * (1 << attempt);
+      std::cerr << "[" << timestamp << "] WARNING: NLSR " << verb << " " << prefix << ": " << reason
+                << ", retrying in " << delay.count() << " ms" << std::endl;
+      m_scheduler.schedule(delay, [this, verb, prefix, attempt, done] {
+        send(verb, prefix, attempt + 1, done);
+      });
+    };
+
+    m_face.expressInterest(interest,
+      [verb, prefix, done] (const Interest&, const Data& data) {
+        auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+        bool isSuccess = false;
+        try {
+          mgmt::ControlResponse response(data.getContent().blockFromValue());
+          isSuccess = response.getCode() < 300;
+          if (isSuccess) {
+            std::cout << "[" << timestamp << "] PREFIX: NLSR " << verb << " " << prefix
+                      << ": " << response.getText() << std::endl;
+          }
+          else {
+            std::cerr << "[" << timestamp << "] ERROR: NLSR " << verb << " " << prefix << " rejected ("
+                      << response.getCode() << "): " << response.getText() << std::endl;
+          }
+        }
+        catch (const tlv::Error& e) {
+          std::cerr << "[" << timestamp << "] ERROR: NLSR " << verb << " " << prefix
+                    << ": malformed response: " << e.what() << std::endl;
+        }
+        if (done) {
+          done(isSuccess);
+        }
+      },
+      [retry] (const Interest&, const lp::Nack& nack) {
+        std::ostringstream reason;
+        reason << "Nack " << nack.getReason();
+        retry(reason.str());
+      },
+      [retry] (const Interest&) {
+        retry("timeout");
+      });
+  }
+
+private:
+  static constexpr time::milliseconds COMMAND_LIFETIME{1000};
+  static constexpr time::milliseconds RETRY_BASE_DELAY{200};
+
+  Face& m_face;
+  security::InterestSigner m_signer;
+  Scheduler& m_scheduler;
+  int m_maxRetries;
+};
+
+/**
+ * @brief Set of (frame, segment) keys in a flat open-addressing table.
+ *
+ * Linear probing over a power-of-two array kept at most half full; erase
+ * shifts the following entries back instead of leaving tombstones, so probe
+ * sequences stay short under steady insert/erase churn. No per-key allocation
+ * and no Name hashing: the key is two integers mixed into one word.
+ */
+class FrameSegmentSet
+{
+public:
+  bool
+  contains(uint64_t frame, uint64_t segment) const
+  {
+    if (m_slots.empty()) {
+      return false;
+    }
+    for (size_t i = indexOf(frame, segment); m_slots[i].isUsed; i = (i + 1) & m_mask) {
+      if (m_slots[i].frame == frame && m_slots[i].segment == segment) {
+        return true;
       }
     }
+    return false;
+  }
 
-    // Serve every parked Interest whose frame has now been produced.
-    for (auto it = m_pendingInterests.begin(); it != m_pendingInterests.end(); ) {
-      if (it->frame <= edge) {
-        serveOne(it->name, it->markMobility, it->mobilitySeq);
-        m_pendingNames.erase(it->name);
-        it = m_pendingInterests.erase(it);
-      }
-      else {
-        ++it;
+  // Returns false, changing nothing, if the key is already present.
+  bool
+  insert(uint64_t frame, uint64_t segment)
+  {
+    if ((m_size + 1) * 2 > m_slots.size()) {
+      rehash(std::max<size_t>(16, m_slots.size() * 2));
+    }
+    size_t i = indexOf(frame, segment);
+    for (; m_slots[i].isUsed; i = (i + 1) & m_mask) {
+      if (m_slots[i].frame == frame && m_slots[i].segment == segment) {
+        return false;
       }
     }
-
-    scheduleDataSend();
+    m_slots[i] = Slot{frame, segment, true};
+    m_size++;
+    return true;
   }
 
   void
-  onInterest(const Interest& interest)
+  erase(uint64_t frame, uint64_t segment)
   {
-    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
-    m_interestCount++;
-    
-    const Name& interestName = interest.getName();
-    std::cout << "[" << timestamp << "] INTEREST: Received #" << m_interestCount
-              << " Name: " << interestName
-              << " CanBePrefix: " << interest.getCanBePrefix()
-              << " MustBeFresh: " << interest.getMustBeFresh() << std::endl;
-
-    // Discovery: a bare "<stream>/_meta" Interest asks for the current live edge.
-    // Reply with a zero-freshness Data carrying the edge stamp, so a MustBeFresh
-    // discovery always reaches the producer instead of a cached copy.
-    if (!interestName.empty() && interestName.get(-1) == name::Component(DISCOVERY_MARKER)) {
-      serveOne(interestName, false, 0, 0_ms);
+    if (m_slots.empty()) {
       return;
     }
-
-    // Content names follow /<stream>/<version=frame>/<segment>; the frame index
-    // gates production against the live edge.
-    uint64_t frame = 0;
-    try {
-      if (interestName.size() >= 2 && interestName.get(-1).isSegment() &&
-          interestName.get(-2).isVersion()) {
-        frame = interestName.get(-2).toVersion();
-      }
-      else {
-        std::cerr << "[" << timestamp << "] INTEREST: Unrecognized name, ignored Name: "
-                  << interestName << std::endl;
-        return;
+    size_t i = indexOf(frame, segment);
+    for (; m_slots[i].isUsed; i = (i + 1) & m_mask) {
+      if (m_slots[i].frame == frame && m_slots[i].segment == segment) {
+        break;
       }
     }
-    catch (const tlv::Error& e) {
-      std::cerr << "[" << timestamp << "] INTEREST: Failed to parse frame index: "
-                << e.what() << std::endl;
+    if (!m_slots[i].isUsed) {
       return;
     }
-
-    if (frame <= edgeNow()) {
-      // The frame has already been produced: serve immediately (catch-up).
-      serveOne(interestName, false, 0);
-    }
-    else if (m_pendingNames.find(interestName) == m_pendingNames.end()) {
-      // Future frame: hold the Interest until the live edge reaches it; drop it
-      // once its own lifetime elapses.
-      auto expiry = time::steady_clock::now() + interest.getInterestLifetime();
-      m_pendingInterests.push_back(PendingInterest{interestName, frame, false, 0, expiry});
-      m_pendingNames.insert(interestName);
-    }
-    else {
-      std::cout << "[" << timestamp << "] INTEREST: Duplicate pending Interest ignored Name: "
-                << interestName << std::endl;
+    // Backward-shift deletion: move up every later entry of the cluster whose
+    // home slot does not lie cyclically in (hole, entry].
+    size_t hole = i;
+    for (size_t j = (i + 1) & m_mask; m_slots[j].isUsed; j = (j + 1) & m_mask) {
+      size_t home = indexOf(m_slots[j].frame, m_slots[j].segment);
+      if (((j - home) & m_mask) >= ((j - hole) & m_mask)) {
+        m_slots[hole] = m_slots[j];
+        hole = j;
+      }
     }
+    m_slots[hole].isUsed = false;
+    m_size--;
+  }
 
-    if (m_forceMobilityOnceFlag) {
-      m_forceMobilityOnceFlag = false;
-      onMobilityEvent();
-    }
+  size_t
+  size() const
+  {
+    return m_size;
   }
 
 private:
+  struct Slot
+  {
+    uint64_t frame = 0;
+    uint64_t segment = 0;
+    bool isUsed = false;
+  };
+
+  size_t
+  indexOf(uint64_t frame, uint64_t segment) const
+  {
+    uint64_t h = frame * 0x9E3779B97F4A7C15ULL ^ (segment + 0x632BE59BD9B4E019ULL) * 0xC2B2AE3D27D4EB4FULL;
+    return static_cast<size_t>(h ^ (h >> 29)) & m_mask;
+  }
+
+  void
+  rehash(size_t capacity)
+  {
+    std::vector<Slot> old = std::exchange(m_slots, std::vector<Slot>(capacity));
+    m_mask = capacity - 1;
+    m_size = 0;
+    for (const auto& slot : old) {
+      if (slot.isUsed) {
+        insert(slot.frame, slot.segment);
+      }
+    }
+  }
+
+private:
+  std::vector<Slot> m_slots;
+  size_t m_mask = 0;
+  size_t m_size = 0;
+};
+
+/**
+ * @brief Bounded ring of recently produced, signed Data keyed by (frame, segment).
+ *
+ * Catch-up Interests and the duplicate copies delivered over several paths by
+ * Interest flooding repeat names the producer has already signed; serving them
+ * from this ring costs no signing or encoding. The oldest entry is overwritten
+ * once the ring is full. The live-edge stamp is pinned to the value current
+ * when the frame was first produced, which consumers tolerate because they only
+ * ever move their edge forward.
+ */
+class ReplyCache : noncopyable
+{
+public:
+  explicit
+  ReplyCache(size_t capacity)
+    : m_slots(capacity)
+  {
+    m_index.reserve(capacity);
+  }
+
+  bool
+  isEnabled() const
+  {
+    return !m_slots.empty();
+  }
+
+  shared_ptr<const Data>
+  find(uint64_t frame, uint64_t segment) const
+  {
+    auto it = m_index.find(Key{frame, segment});
+    return it == m_index.end() ? nullptr : m_slots[it->second].data;
+  }
+
+  void
+  insert(uint64_t frame, uint64_t segment, shared_ptr<const Data> data)
+  {
+    if (!isEnabled()) {
+      return;
+    }
+    // A key already cached is replaced in its slot, so the index never holds a
+    // key twice.
+    Key key{frame, segment};
+    auto existing = m_index.find(key);
+    if (existing != m_index.end()) {
+      m_slots[existing->second].data = std::move(data);
+      return;
+    }
+    Slot& slot = m_slots[m_next];
+    if (slot.data != nullptr) {
+      m_index.erase(slot.key);
+    }
+    slot.key = key;
+    slot.data = std::move(data);
+    m_index[slot.key] = m_next;
+    m_next = (m_next + 1) % m_slots.size();
+  }
+
+private:
+  struct Key {
+    uint64_t frame = 0;
+    uint64_t segment = 0;
+
+    bool
+    operator==(const Key& other) const
+    {
+      return frame == other.frame && segment == other.segment;
+    }
+  };
+
+  struct KeyHash {
+    size_t
+    operator()(const Key& key) const
+    {
+      return std::hash<uint64_t>()(key.frame * 0x9E3779B97F4A7C15ULL ^ key.segment);
+    }
+  };
+
+  struct Slot {
+    Key key;
+    shared_ptr<const Data> data;
+  };
+
+  std::vector<Slot> m_slots;
+  size_t m_next = 0;
+  std::unordered_map<Key, size_t, KeyHash> m_index;
+};
+
+
+/**
+ * @brief Read-only memory mapping that supplies the content of each segment.
+ *
+ * Backed by a media file (EXP_PAYLOAD_FILE) or, without one, by an anonymous
+ * mapping filled with a fixed pattern, so payload size can be varied without a
+ * file. The file is cut into whole segments of segmentBytes; segment S of frame
+ * N of a K-segment frame is segment (N*K + S) of the file, wrapping around at
+ * its end. Content is copied straight from the mapping into the Data's content
+ * block: ndn-cxx Blocks own their memory, so that one copy cannot be avoided,
+ * but no intermediate buffer or read() is involved. The mapping is immutable,
+ * so signing workers and shards may read it concurrently.
+ */
+class PayloadSource : noncopyable
+{
+public:
+  PayloadSource(const std::string& path, size_t segmentBytes)
+    : m_segmentBytes(segmentBytes)
+  {
+    if (segmentBytes == 0 || segmentBytes > MAX_SEGMENT_BYTES) {
+      throw std::invalid_argument("EXP_SEGMENT_BYTES must be in 1.." + std::to_string(MAX_SEGMENT_BYTES));
+    }
+
+    if (path.empty()) {
+      m_size = segmentBytes * SYNTHETIC_SEGMENTS;
+      void* addr = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (addr == MAP_FAILED) {
+        throw std::runtime_error(std::string("Failed to map synthetic payload: ") + strerror(errno));
+      }
+      auto bytes = static_cast<uint8_t*>(addr);
+      for (size_t i = 0; i < m_size; ++i) {
+        bytes[i] = static_cast<uint8_t>(i * 31 + 7);
+      }
+      mprotect(addr, m_size, PROT_READ);
+      m_base = bytes;
+    }
+    else {
+      int fd = open(path.data(), O_RDONLY);
+      if (fd < 0) {
+        throw std::runtime_error("Failed to open payload file " + path + ": " + strerror(errno));
+      }
+      struct stat st;
+      if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        close(fd);
+        throw std::runtime_error("Payload file " + path + " is empty or unreadable");
+      }
+      m_size = static_cast<size_t>(st.st_size);
+      void* addr = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      close(fd);
+      if (addr == MAP_FAILED) {
+        throw std::runtime_error("Failed to map payload file " + path + ": " + strerror(errno));
+      }
+      // Frames are read in order; let the kernel read ahead.
+      madvise(addr, m_size, MADV_SEQUENTIAL);
+      madvise(addr, m_size, MADV_WILLNEED);
+      m_base = static_cast<const uint8_t*>(addr);
+    }
+
+    // A file shorter than one segment is served whole.
+    m_segmentBytes = std::min(m_segmentBytes, m_size);
+    m_segmentCount = m_size / m_segmentBytes;
+  }
+
+  ~PayloadSource()
+  {
+    munmap(const_cast<uint8_t*>(m_base), m_size);
+  }
+
+  size_t
+  segmentBytes() const
+  {
+    return m_segmentBytes;
+  }
+
+  // The first <bytes> (at most segmentBytes()) of file segment <index>.
+  span<const uint8_t>
+  segment(uint64_t index, size_t bytes) const
+  {
+    return make_span(m_base + (index % m_segmentCount) * m_segmentBytes,
+                     std::min(bytes, m_segmentBytes));
+  }
+
+private:
+  static constexpr size_t SYNTHETIC_SEGMENTS = 64;
+
+  const uint8_t* m_base = nullptr;
+  size_t m_size = 0;
+  size_t m_segmentBytes = 0;
+  uint64_t m_segmentCount = 0;
+};
+
+/**
+ * @brief Per-frame sizes from a frame-size trace (EXP_FRAME_TRACE), such as a GOP
+ *        trace of an encoded video.
+ *
+ * One frame per line; '#' starts a comment. The size in bytes is the last
+ * column, or column EXP_FRAME_TRACE_COLUMN (0-based), so both plain size lists
+ * and the usual "index time type size ..." traces load; a header line naming
+ * the columns may precede the first frame. Frame N takes entry N mod length:
+ * a trace of one GOP repeats.
+ */
+class FrameTrace : noncopyable
+{
+public:
+  FrameTrace(const std::string& path, int column)
+  {
+    std::ifstream file(path);
+    if (!file) {
+      throw std::runtime_error("Failed to open frame trace " + path);
+    }
+    std::string line;
+    size_t lineNumber = 0;
+    bool hasHeader = false;
+    while (std::getline(file, line)) {
+      lineNumber++;
+      line = line.substr(0, line.find('#'));
+      std::istringstream fields(line);
+      std::vector<std::string> columns;
+      for (std::string field; fields >> field; ) {
+        columns.push_back(field);
+      }
+      if (columns.empty()) {
+        continue;
+      }
+      size_t index = column < 0 ? columns.size() - 1 : static_cast<size_t>(column);
+      std::string where = path + ":" + std::to_string(lineNumber);
+      if (index >= columns.size()) {
+        throw std::runtime_error("Frame trace " + where + " has no column " + std::to_string(index) +
+                                 ": " + line);
+      }
+      const std::string& field = columns[index];
+      size_t bytes = 0;
+      auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), bytes);
+      if (error != std::errc() || end != field.data() + field.size()) {
+        if (m_sizes.empty() && !hasHeader) {
+          hasHeader = true;
+          continue;
+        }
+        throw std::runtime_error("Frame trace " + where + " has a malformed frame size: " + field);
+      }
+      m_sizes.push_back(bytes);
+      m_maxBytes = std::max(m_maxBytes, m_sizes.back());
+      m_totalBytes += m_sizes.back();
+    }
+    if (m_sizes.empty()) {
+      throw std::runtime_error("Frame trace " + path + " has no frames");
+    }
+  }
+
+  size_t
+  frameBytes(uint64_t frame) const
+  {
+    return m_sizes[frame % m_sizes.size()];
+  }
+
+  size_t
+  frameCount() const
+  {
+    return m_sizes.size();
+  }
+
+  size_t
+  maxFrameBytes() const
+  {
+    return m_maxBytes;
+  }
+
+  double
+  meanFrameBytes() const
+  {
+    return static_cast<double>(m_totalBytes) / m_sizes.size();
+  }
+
+private:
+  std::vector<size_t> m_sizes;
+  size_t m_maxBytes = 0;
+  uint64_t m_totalBytes = 0;
+};
+
+/**
+ * @brief Log-linear (HDR-style) latency histogram over nanoseconds.
+ *
+ * Each power of two is split into 8 linear sub-buckets, so any value, from
+ * nanoseconds to hours, is kept within 12.5% relative error; recording is a
+ * few bit operations and no allocation. Quantiles are read back directly, and
+ * the histogram exports in OpenMetrics text format with power-of-two bounds,
+ * which coincide with bucket edges.
+ */
+class LatencyHistogram
+{
+public:
+  void
+  record(time::nanoseconds latency)
+  {
+    uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(0, latency.count()));
+    m_counts[bucketOf(ns)]++;
+    m_count++;
+    m_sumNs += ns;
+    m_maxNs = std::max(m_maxNs, ns);
+  }
+
+  uint64_t
+  count() const
+  {
+    return m_count;
+  }
+
+  // Upper bound of the bucket holding quantile q (0..1), capped at the maximum.
+  uint64_t
+  quantileNs(double q) const
+  {
+    if (m_count == 0) {
+      return 0;
+    }
+    auto rank = static_cast<uint64_t>(std::ceil(q * m_count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_counts.size(); ++i) {
+      seen += m_counts[i];
+      if (seen >= std::max<uint64_t>(rank, 1)) {
+        return std::min(upperBoundOf(i), m_maxNs);
+      }
+    }
+    return m_maxNs;
+  }
+
+  // One line: count, mean and quantiles in microseconds.
+  void
+  writeSummary(std::ostream& os) const
+  {
+    os << "count=" << m_count
+       << " mean_us=" << (m_count > 0 ? m_sumNs / 1e3 / m_count : 0.0)
+       << " p50_us=" << quantileNs(0.5) / 1e3
+       << " p90_us=" << quantileNs(0.9) / 1e3
+       << " p99_us=" << quantileNs(0.99) / 1e3
+       << " p999_us=" << quantileNs(0.999) / 1e3
+       << " max_us=" << m_maxNs / 1e3;
+  }
+
+  // Write the histogram as metric <name> (unit: seconds) with the given label
+  // set, e.g. stream="/LiveStream/v0"; buckets are cumulative, from 2^13 ns
+  // (~8 us) to 2^30 ns (~1.07 s).
+  void
+  writeOpenMetrics(std::ostream& os, const std::string& name, const std::string& labels = "") const
+  {
+    std::string sep = labels.empty() ? "" : ",";
+    auto precision = os.precision(9);
+    uint64_t cumulative = 0;
+    size_t bucket = 0;
+    for (int exponent = 13; exponent <= 30; ++exponent) {
+      for (; bucket < bucketOf(uint64_t(1) << exponent); ++bucket) {
+        cumulative += m_counts[bucket];
+      }
+      os << name << "_bucket{" << labels << sep << "le=\"" << (uint64_t(1) << exponent) / 1e9 << "\"} "
+         << cumulative << "\n";
+    }
+    os << name << "_bucket{" << labels << sep << "le=\"+Inf\"} " << m_count << "\n";
+    std::string braced = labels.empty() ? "" : "{" + labels + "}";
+    os << name << "_sum" << braced << " " << m_sumNs / 1e9 << "\n";
+    os << name << "_count" << braced << " " << m_count << "\n";
+    os.precision(precision);
+  }
+
+private:
+  static constexpr int SUB_BITS = 3;
+  static constexpr uint64_t LINEAR_LIMIT = uint64_t(1) << (SUB_BITS + 1);
+
+  // Values below 16 ns map one to one; above, bucket = (power of two, the next
+  // SUB_BITS bits below the leading one).
+  static size_t
+  bucketOf(uint64_t ns)
+  {
+    if (ns < LINEAR_LIMIT) {
+      return static_cast<size_t>(ns);
+    }
+    int exponent = 63 - __builtin_clzll(ns);
+    uint64_t sub = (ns >> (exponent - SUB_BITS)) & ((uint64_t(1) << SUB_BITS) - 1);
+    return LINEAR_LIMIT + (exponent - SUB_BITS - 1) * (uint64_t(1) << SUB_BITS) + sub;
+  }
+
+  static uint64_t
+  upperBoundOf(size_t bucket)
+  {
+    if (bucket < LINEAR_LIMIT) {
+      return bucket;
+    }
+    size_t offset = bucket - LINEAR_LIMIT;
+    int exponent = static_cast<int>(offset >> SUB_BITS) + SUB_BITS + 1;
+    uint64_t sub = offset & ((uint64_t(1) << SUB_BITS) - 1);
+    uint64_t lower = ((uint64_t(1) << SUB_BITS) + sub) << (exponent - SUB_BITS);
+    return lower + (uint64_t(1) << (exponent - SUB_BITS)) - 1;
+  }
+
+  static constexpr size_t BUCKETS = LINEAR_LIMIT + (64 - SUB_BITS - 1) * (size_t(1) << SUB_BITS);
+
+  std::array<uint64_t, BUCKETS> m_counts{};
+  uint64_t m_count = 0;
+  uint64_t m_sumNs = 0;
+  uint64_t m_maxNs = 0;
+};
+
+/**
+ * @brief State shared by all shards of one producer process.
+ */
+struct ProducerShared
+{
+  std::unique_ptr<EventLog> eventLog;
+  std::unique_ptr<PayloadSource> payload;
+  std::unique_ptr<FrameTrace> trace;   // only together with payload
+  // FloodIds must be unique per process, whichever shard marks the Data.
+  std::atomic<uint64_t> floodIdSeq{0};
+  // Flood budget of the latest mobility event (EXP_MARK_BUDGET). Every shard
+  // handles each event, so they spend from this one budget, not one each.
+  std::mutex markBudgetMutex;
+  uint64_t markBudgetEvent = 0;
+  uint64_t markBudgetLeft = 0;
+};
+
+/**
+ * @brief One producer event loop: a Face, scheduler and KeyChain serving the
+ *        streams assigned to it.
+ *
+ * A process runs one Producer per shard (EXP_PRODUCER_SHARDS, default 1), each
+ * on its own thread. Stream i belongs to shard i % shardCount. NFD dispatches
+ * Interests to shards by longest prefix match on the stream prefixes each shard
+ * registers, so a stream is never split across shards.
+ */
+class Producer : noncopyable
+{
+public:
+  explicit
+  Producer(ProducerShared& shared, size_t shard = 0, size_t shardCount = 1)
+    : m_face(m_ioContext)
+    , m_scheduler(m_ioContext)
+    , m_keyChain()
+    , m_shared(shared)
+    , m_shard(shard)
+    , m_shardCount(shardCount)
+  {
+    // Frame production period: a new frame becomes available every interval,
+    // supplied by the driver via EXP_REQUEST_INTERVAL_MS (20 ms safety-net default).
+    const char* rawInterval = std::getenv("EXP_REQUEST_INTERVAL_MS");
+    int intervalMs = rawInterval ? std::atoi(rawInterval) : 20;
+    if (intervalMs <= 0) {
+      intervalMs = 20;
+    }
+
+    // Segments per frame (K). FinalBlockId on every segment advertises K-1 so the
+    // consumer can fetch all segments. Supplied via EXP_SEGMENTS_PER_FRAME (default 1).
+    const char* rawSegments = std::getenv("EXP_SEGMENTS_PER_FRAME");
+    int segmentsPerFrame = rawSegments ? std::atoi(rawSegments) : 1;
+    if (segmentsPerFrame <= 0) {
+      segmentsPerFrame = 1;
+    }
+
+    // Forward error correction (EXP_FEC_PARITY=R): R parity segments follow the
+    // K source segments of every frame, so any K of the K+R rebuild it (see
+    // fec.hpp). Default 0, no parity.
+    const char* rawParity = std::getenv("EXP_FEC_PARITY");
+    m_fecParity = rawParity ? std::max(0, std::atoi(rawParity)) : 0;
+
+    // Produce-ahead pipeline: EXP_SIGN_WORKERS > 0 signs every frame on that many
+    // worker threads at its boundary (default 0, sign on demand).
+    const char* rawSignWorkers = std::getenv("EXP_SIGN_WORKERS");
+    m_signWorkers = rawSignWorkers ? std::atoi(rawSignWorkers) : 0;
+    if (m_signWorkers < 0) {
+      m_signWorkers = 0;
+    }
+
+    // Signed-reply ring per stream for repeated (frame, segment) names;
+    // EXP_REPLY_CACHE_ENTRIES=0 disables it (default 1024). The pipeline delivers
+    // through the ring, so it is kept large enough for the frames the pipeline
+    // may hold in flight.
+    const char* rawCacheEntries = std::getenv("EXP_REPLY_CACHE_ENTRIES");
+    int cacheEntries = rawCacheEntries ? std::atoi(rawCacheEntries) : 1024;
+
+    configureStreams(time::milliseconds(intervalMs), segmentsPerFrame);
+    for (auto& stream : m_streams) {
+      if (m_fecParity > 0 && maxSegments(*stream) + m_fecParity > static_cast<int>(fec::MAX_SEGMENTS)) {
+        throw std::invalid_argument("EXP_FEC_PARITY: " + stream->prefix.toUri() + " needs more than " +
+                                    std::to_string(fec::MAX_SEGMENTS) + " segments per frame");
+      }
+      int entries = cacheEntries;
+      if (m_signWorkers > 0) {
+        entries = std::max(entries, 2 * MAX_FRAMES_IN_FLIGHT * (maxSegments(*stream) + m_fecParity));
+      }
+      stream->replyCache = std::make_unique<ReplyCache>(entries > 0 ? entries : 0);
+    }
+
+    // Binary per-packet event log, opened once per process (see main).
+    m_eventLog = m_shared.eventLog.get();
+    if (m_eventLog) {
+      for (const auto& stream : m_streams) {
+        m_eventLog->definePrefix(stream->prefix);
+      }
+    }
+
+    // Per-frame manifest (EXP_FRAME_MANIFEST=1): one signature per frame instead
+    // of one per segment. Default off.
+    const char* rawManifest = std::getenv("EXP_FRAME_MANIFEST");
+    m_frameManifest = rawManifest && std::atoi(rawManifest) > 0;
+    // The manifest travels in segment 0 beside its payload, and both must fit in
+    // the MAX_SEGMENT_BYTES left for content; a larger segment 0 would be dropped
+    // on send and lose the whole frame.
+    if (m_frameManifest) {
+      size_t headBytes = m_shared.payload ? m_shared.payload->segmentBytes() : MARKER_CONTENT.size();
+      size_t maxEntries = (MAX_SEGMENT_BYTES - std::min(MAX_SEGMENT_BYTES, headBytes + MANIFEST_HEADER_BYTES)) /
+                          MANIFEST_ENTRY_BYTES;
+      for (const auto& stream : m_streams) {
+        size_t entries = static_cast<size_t>(maxSegments(*stream) + m_fecParity - 1);
+        if (entries > maxEntries) {
+          throw std::invalid_argument("EXP_FRAME_MANIFEST: " + stream->prefix.toUri() + " needs " +
+                                      std::to_string(entries) + " manifest entries, segment 0 holds at most " +
+                                      std::to_string(maxEntries));
+        }
+      }
+    }
+
+    // Signature algorithm (EXP_SIGNING, default ecdsa); must match the consumer.
+    m_signingMode = signingModeFromEnv();
+    m_signingInfo = makeSigningInfo(m_signingMode, hmacKeyFromEnv());
+    checkSigningKey();
+
+    m_markingPolicy = MarkingPolicy::fromEnv();
+
+    // Pending-table admission: at most EXP_PENDING_CAP parked Interests per shard,
+    // for frames at most EXP_MAX_LOOKAHEAD_FRAMES past the live edge (0, the
+    // default, leaves either unbounded). Rejects are answered per EXP_REJECT_WITH:
+    // "data" (application Nack, default) or "nack" (network Nack).
+    const char* rawPendingCap = std::getenv("EXP_PENDING_CAP");
+    m_pendingCap = rawPendingCap ? static_cast<size_t>(std::max(0, std::atoi(rawPendingCap))) : 0;
+    const char* rawLookahead = std::getenv("EXP_MAX_LOOKAHEAD_FRAMES");
+    m_maxLookaheadFrames = rawLookahead ? static_cast<uint64_t>(std::max(0, std::atoi(rawLookahead))) : 0;
+    if (const char* rawRejectWith = std::getenv("EXP_REJECT_WITH"); rawRejectWith && rawRejectWith[0] != '\0') {
+      std::string rejectWith = rawRejectWith;
+      if (rejectWith != "data" && rejectWith != "nack") {
+        throw std::invalid_argument("Unknown EXP_REJECT_WITH '" + rejectWith + "' (expected data or nack)");
+      }
+      m_rejectWithNack = rejectWith == "nack";
+    }
+
+    // Frames re-sent flood-marked on a mobility event, after the announcement
+    // (EXP_MOBILITY_REFRESH_FRAMES, default 0).
+    const char* rawRefreshFrames = std::getenv("EXP_MOBILITY_REFRESH_FRAMES");
+    m_mobilityRefreshFrames = rawRefreshFrames ? std::max(0, std::atoi(rawRefreshFrames)) : 0;
+
+    // NLSR prefix-update commands are retried EXP_NLSR_RETRIES times (default 3).
+    const char* rawNlsrRetries = std::getenv("EXP_NLSR_RETRIES");
+    int nlsrRetries = rawNlsrRetries ? std::max(0, std::atoi(rawNlsrRetries)) : 3;
+    m_nlsrControl = std::make_unique<NlsrPrefixControl>(m_face, m_keyChain, m_scheduler, nlsrRetries);
+
+    // Due Interests served round-robin across downstreams (EXP_FAIR_SERVE=1)
+    // instead of in frame and arrival order, with per-downstream counters.
+    // Default off.
+    const char* rawFair = std::getenv("EXP_FAIR_SERVE");
+    m_fairServe = rawFair && std::atoi(rawFair) > 0;
+
+    // Mobility triggers (EXP_MOBILITY_TRIGGERS: any of link,addr,route; default
+    // link) and their per-interface debounce window (EXP_MOBILITY_DEBOUNCE_MS).
+    if (const char* rawTriggers = std::getenv("EXP_MOBILITY_TRIGGERS")) {
+      m_mobilityOptions.onLink = false;
+      for (const auto& trigger : splitList(rawTriggers)) {
+        if (trigger == "link") {
+          m_mobilityOptions.onLink = true;
+        }
+        else if (trigger == "addr") {
+          m_mobilityOptions.onAddress = true;
+        }
+        else if (trigger == "route") {
+          m_mobilityOptions.onRoute = true;
+        }
+        else {
+          throw std::invalid_argument("Unknown mobility trigger '" + trigger +
+                                      "' in EXP_MOBILITY_TRIGGERS (expected link, addr or route)");
+        }
+      }
+    }
+    if (const char* rawDebounce = std::getenv("EXP_MOBILITY_DEBOUNCE_MS")) {
+      m_mobilityOptions.debounce = std::chrono::milliseconds(std::max(0, std::atoi(rawDebounce)));
+    }
+
+    // Data released in one event-loop tick are put to the Face together at the end
+    // of the tick (EXP_BATCH_TX=1) instead of as each is produced. Default off.
+    const char* rawBatch = std::getenv("EXP_BATCH_TX");
+    m_batchTx = rawBatch && std::atoi(rawBatch) > 0;
+
+    // Paced, prioritised transmit (EXP_PACING_MBPS > 0, split evenly across
+    // shards) through a token bucket of EXP_PACING_BURST_BYTES (default 64 KiB);
+    // at most EXP_PACING_QUEUE replies wait (default 4096). Default off.
+    const char* rawPacing = std::getenv("EXP_PACING_MBPS");
+    double pacingMbps = rawPacing ? std::atof(rawPacing) : 0;
+    if (pacingMbps > 0) {
+      m_pacingBytesPerSec = pacingMbps * 1e6 / 8 / m_shardCount;
+      const char* rawBurst = std::getenv("EXP_PACING_BURST_BYTES");
+      int burst = rawBurst ? std::atoi(rawBurst) : 0;
+      m_pacingBurstBytes = burst > 0 ? burst : 65536;
+      const char* rawQueue = std::getenv("EXP_PACING_QUEUE");
+      int queueCap = rawQueue ? std::atoi(rawQueue) : 0;
+      m_pacingQueueCap = queueCap > 0 ? static_cast<size_t>(queueCap) : 4096;
+      m_tokens = m_pacingBurstBytes;
+      m_tokensUpdated = time::steady_clock::now();
+    }
+
+    // Segment replies patched into pre-encoded wire templates (EXP_DATA_TEMPLATE=1)
+    // instead of being built and encoded field by field. Default off.
+    const char* rawTemplate = std::getenv("EXP_DATA_TEMPLATE");
+    m_dataTemplates = rawTemplate && std::atoi(rawTemplate) > 0;
+    if (m_dataTemplates) {
+      if (isAsymmetric(m_signingMode)) {
+        m_signingKeyName = m_keyChain.getPib().getDefaultIdentity().getDefaultKey().getName();
+      }
+      else if (m_signingMode == SigningMode::HMAC) {
+        m_hmacSigner.emplace(hmacKeyFromEnv());
+      }
+    }
+
+    // Default to disabled; enable automatically in solution builds
+#ifdef SOLUTION_ENABLED
+    m_enableOptoFlood = true;
+#endif
+  }
+
+  void enableOptoFlood(bool enable = true) { m_enableOptoFlood = enable; }
+  void forceMobilityOnce() { m_enableOptoFlood = true; m_forceMobilityOnceFlag = true; }
+
+  // Called for each detected mobility event instead of marking only this
+  // shard's Interests; the sharded producer broadcasts through it.
+  void
+  setMobilityHandler(std::function<void()> handler)
+  {
+    m_mobilityHandler = std::move(handler);
+  }
+
+  // Thread-safe: handle a mobility event on this shard's own event loop.
+  void
+  postMobilityEvent()
+  {
+    boost::asio::post(m_ioContext, [this] { onMobilityEvent(); });
+  }
+
+  // Thread-safe: make run() return.
+  void
+  stop()
+  {
+    m_ioContext.stop();
+  }
+
+  void
+  run()
+  {
+    // Register prefix with a success callback to advertise it via NLSR. A single
+    // shard takes all of /LiveStream; shards register only their own streams.
+    if (m_shardCount == 1) {
+      m_face.setInterestFilter(STREAM_ROOT,
+                               std::bind(&Producer::onInterest, this, _2),
+                               std::bind(&Producer::onRegisterSuccess, this, _1),
+                               std::bind(&Producer::onRegisterFailed, this, _1, _2));
+    }
+    else {
+      for (const auto& stream : m_streams) {
+        m_face.setInterestFilter(stream->prefix,
+                                 std::bind(&Producer::onInterest, this, _2),
+                                 std::bind(&Producer::onRegisterSuccess, this, _1),
+                                 std::bind(&Producer::onRegisterFailed, this, _1, _2));
+      }
+    }
+    // Downstreams are told apart by the IncomingFaceId NFD attaches once local
+    // fields are enabled on this application's face.
+    if (m_fairServe) {
+      enableLocalFields();
+    }
+    // Interface changes are watched once per process, by shard 0.
+    if (m_enableOptoFlood && m_shard == 0) {
+    try {
+        if (!m_netlinkListener) {
+          m_netlinkListener = std::make_unique<NetlinkListener>(
+            m_ioContext, [this] { m_mobilityHandler(); }, m_mobilityOptions
+          );
+        }
+      m_netlinkListener->start();
+      std::cout << "Netlink listener started for mobility detection." << std::endl;
+    }
+    catch (const std::exception& e) {
+      std::cerr << "ERROR: Failed to start Netlink listener: " << e.what() << std::endl;
+    }
+    }
+    // Stage histograms are dumped on SIGUSR1, and once more on SIGINT/SIGTERM,
+    // which then stop the event loop so the process exits cleanly.
+    m_signals.add(SIGUSR1);
+    m_signals.add(SIGINT);
+    m_signals.add(SIGTERM);
+    waitForSignal();
+
+    // Metrics are also served on a Unix socket (EXP_STATS_SOCKET), one per shard:
+    // shard N > 0 appends ".N" to the path. Each connection gets one snapshot.
+    if (const char* rawSocket = std::getenv("EXP_STATS_SOCKET"); rawSocket && rawSocket[0] != '\0') {
+      std::string path = rawSocket;
+      if (m_shard > 0) {
+        path += "." + std::to_string(m_shard);
+      }
+      startStatsSocket(path);
+    }
+
+    // Frames are released on demand: a stream's release timer is armed only once
+    // an Interest is parked on it (see armRelease).
+    auto startTime = time::steady_clock::now();
+    for (auto& stream : m_streams) {
+      stream->startTime = startTime;
+    }
+    if (m_signWorkers > 0) {
+      m_signPool = std::make_unique<boost::asio::thread_pool>(m_signWorkers);
+      std::cout << "Produce-ahead pipeline started with " << m_signWorkers
+                << " signing workers." << std::endl;
+      for (auto& stream : m_streams) {
+        scheduleProduction(*stream, 0);
+      }
+    }
+    m_ioContext.run();
+  }
+
+private:
+  // Why pending-table admission refused an Interest.
+  enum class RejectReason { TOO_FAR_AHEAD, TABLE_FULL };
+
+  // A parked Interest is keyed by its (frame, segment) within the stream; its
+  // Name is rebuilt from the stream prefix when it is served. Only a name that
+  // would not rebuild byte for byte (another prefix, non-minimal numbers) is
+  // kept as is, and is then also its own key.
   struct PendingInterest {
-    Name name;
     uint64_t frame = 0;
-    bool markMobility = false;
-    uint32_t mobilitySeq = 0;
-    time::steady_clock::time_point expiry{};
-  };
+    Name name;                  // empty unless the name does not rebuild
+    uint64_t segment = 0;
+    uint64_t id = 0;            // matches the heap entries of this Interest; 0 when the slot is free
+    bool markMobility = false;
+    uint32_t mobilitySeq = 0;
+    time::steady_clock::time_point arrival{};   // Interest received
+    time::steady_clock::time_point parked{};    // entered the pending table
+    uint64_t downstream = 0;    // see downstreamOf
+  };
+
+  // Per-downstream counters (EXP_FAIR_SERVE), downstreams keyed by downstreamOf.
+  struct DownstreamStats {
+    uint64_t interests = 0;     // content Interests received
+    uint64_t parked = 0;
+    uint64_t rejected = 0;      // refused by pending-table admission
+    uint64_t served = 0;        // answered, at once or from the pending table
+  };
+
+  // Heap entries name a slot of the stream's pending pool and the id of the
+  // Interest they were pushed for; the slot may since have been freed or reused.
+  struct PendingExpiry {
+    time::steady_clock::time_point expiry{};
+    uint64_t id = 0;
+    uint32_t slot = 0;
+
+    bool
+    operator>(const PendingExpiry& other) const
+    {
+      return expiry > other.expiry;
+    }
+  };
+
+  // Release order is frame order, then arrival order within a frame.
+  struct PendingRelease {
+    uint64_t frame = 0;
+    uint64_t id = 0;
+    uint32_t slot = 0;
+
+    bool
+    operator>(const PendingRelease& other) const
+    {
+      return std::tie(frame, id) > std::tie(other.frame, other.id);
+    }
+  };
+
+  // Pre-encoded wire of a segment reply: Name through SignatureInfo, with the
+  // offsets of the fields that differ per packet. Name components keep their
+  // minimal encoding, since a Data name must match the Interest name byte for
+  // byte, so each template serves one (version, segment) encoding width. The
+  // live edge is encoded on a fixed 8 bytes.
+  struct DataTemplate {
+    Buffer signedPortion;
+    size_t versionOffset = 0;
+    size_t segmentOffset = 0;
+    size_t edgeOffset = 0;
+    size_t contentOffset = 0;
+    size_t contentSize = 0;
+  };
+
+  // One hosted live stream: its own frame clock and segment count, pending table,
+  // release timer, reply ring and pipeline state. The Face, scheduler, signing
+  // configuration and mobility handling are shared by all streams.
+  struct Stream {
+    Name prefix;
+    time::milliseconds interval{20};
+    int segmentsPerFrame = 1;
+    time::steady_clock::time_point startTime;
+
+    // Parked Interests live in a slot pool. A min-heap on frame releases them
+    // and a min-heap on deadline expires them, so a tick visits only the
+    // Interests that become due or expire; entries whose Interest has already
+    // left the pool are discarded as they surface.
+    std::vector<PendingInterest> pendingSlots;
+    std::vector<uint32_t> freePendingSlots;
+    std::priority_queue<PendingRelease, std::vector<PendingRelease>, std::greater<>> releaseHeap;
+    std::priority_queue<PendingExpiry, std::vector<PendingExpiry>, std::greater<>> expiryHeap;
+    // Due, but the frame is still being signed; its completion releases them.
+    std::vector<PendingRelease> heldForPipeline;
+    // Duplicate index: a name that rebuilds from the prefix is identified by its
+    // (frame, segment) alone; any other is compared as a whole Name.
+    FrameSegmentSet pendingKeys;
+    std::set<Name> pendingNames;
+    size_t pendingCount = 0;
+
+    // Release timer, armed for the next frame boundary with parked work.
+    scheduler::ScopedEventId releaseEvent;
+    time::steady_clock::time_point releaseTarget;
+    bool releaseArmed = false;
+    bool releaseIsFrameBoundary = false;
+
+    std::unique_ptr<ReplyCache> replyCache;
+
+    // Produce-ahead pipeline state; frames map to their segments still being signed.
+    scheduler::ScopedEventId productionEvent;
+    std::map<uint64_t, int> framesInFlight;
+
+    // Wire templates of segment replies, one per (version, segment) encoding
+    // width, built on first use; scratch is the buffer they are patched in.
+    std::array<std::unique_ptr<DataTemplate>, 16> templates;
+    Buffer templateScratch;
+  };
+
+  // Streams hosted by this process. EXP_STREAMS is either a count N, giving
+  // /LiveStream/v0 .. /LiveStream/v<N-1>, or a comma-separated list of prefixes
+  // under /LiveStream; when unset, the single stream is EXP_STREAM_PREFIX
+  // (default /LiveStream/v0), matching the consumer. EXP_STREAM_INTERVALS_MS and
+  // EXP_STREAM_SEGMENTS optionally list the frame period and K of each stream in
+  // the same order; missing entries take EXP_REQUEST_INTERVAL_MS and
+  // EXP_SEGMENTS_PER_FRAME.
+  //
+  // EXP_LAYERS publishes every stream as quality layers instead, listed by K from
+  // the lightest: "1,4,8" gives <stream>/l0, <stream>/l1 and <stream>/l2 with 1,
+  // 4 and 8 segments per frame. Layers are streams of their own that share the
+  // frame timeline (period and start) and shard of their parent.
+  void
+  configureStreams(time::milliseconds defaultInterval, int defaultSegments)
+  {
+    std::vector<std::string> prefixes = splitList(std::getenv("EXP_STREAMS"));
+    if (prefixes.size() == 1 &&
+        std::all_of(prefixes[0].begin(), prefixes[0].end(), [] (unsigned char c) { return std::isdigit(c); })) {
+      int count = std::atoi(prefixes[0].data());
+      if (count <= 0) {
+        throw std::invalid_argument("EXP_STREAMS must be a positive count or a list of prefixes");
+      }
+      prefixes.clear();
+      for (int i = 0; i < count; ++i) {
+        prefixes.push_back(STREAM_ROOT + std::string("/v") + std::to_string(i));
+      }
+    }
+    else if (prefixes.empty()) {
+      const char* rawStreamPrefix = std::getenv("EXP_STREAM_PREFIX");
+      prefixes.push_back(rawStreamPrefix && rawStreamPrefix[0] != '\0'
+                         ? rawStreamPrefix : "/LiveStream/v0");
+    }
+
+    std::vector<std::string> intervals = splitList(std::getenv("EXP_STREAM_INTERVALS_MS"));
+    std::vector<std::string> segments = splitList(std::getenv("EXP_STREAM_SEGMENTS"));
+    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+
+    if (m_shardCount > prefixes.size()) {
+      throw std::invalid_argument("EXP_PRODUCER_SHARDS exceeds the number of streams");
+    }
+
+    std::vector<std::string> layers = splitList(std::getenv("EXP_LAYERS"));
+    for (const auto& layer : layers) {
+      if (std::atoi(layer.data()) <= 0) {
+        throw std::invalid_argument("EXP_LAYERS must list a positive segment count per layer");
+      }
+    }
+    if (!layers.empty() && m_shared.trace != nullptr) {
+      throw std::invalid_argument("EXP_LAYERS cannot be combined with EXP_FRAME_TRACE");
+    }
+
+    std::unordered_set<Name> allPrefixes;
+    for (size_t i = 0; i < prefixes.size(); ++i) {
+      Name prefix(prefixes[i]);
+      if (!Name(STREAM_ROOT).isPrefixOf(prefix)) {
+        throw std::invalid_argument("Stream prefix " + prefixes[i] + " is not under " + STREAM_ROOT);
+      }
+      if (!allPrefixes.insert(prefix).second) {
+        throw std::invalid_argument("Duplicate stream prefix " + prefixes[i]);
+      }
+      int intervalMs = i < intervals.size() ? std::atoi(intervals[i].data()) : 0;
+      int k = i < segments.size() ? std::atoi(segments[i].data()) : 0;
+
+      // Without layers, the stream is its own single layer.
+      std::vector<std::pair<Name, int>> published;
+      if (layers.empty()) {
+        published.emplace_back(prefix, k > 0 ? k : defaultSegments);
+      }
+      for (size_t l = 0; l < layers.size(); ++l) {
+        published.emplace_back(Name(prefix).append(("l" + std::to_string(l)).c_str()),
+                               std::atoi(layers[l].data()));
+      }
+
+      if (i % m_shardCount != m_shard) {
+        continue;
+      }
+      for (const auto& [layerPrefix, layerSegments] : published) {
+        auto stream = std::make_unique<Stream>();
+        stream->prefix = layerPrefix;
+        stream->interval = intervalMs > 0 ? time::milliseconds(intervalMs) : defaultInterval;
+        stream->segmentsPerFrame = layerSegments;
+        std::cout << "[" << timestamp << "] STARTUP: Shard " << m_shard << " stream " << stream->prefix
+                  << " frame period " << stream->interval.count() << " ms, "
+                  << stream->segmentsPerFrame << " segments per frame" << std::endl;
+        m_streamsByPrefix.emplace(stream->prefix, stream.get());
+        m_streams.push_back(std::move(stream));
+      }
+    }
+  }
+
+  static std::vector<std::string>
+  splitList(const char* raw)
+  {
+    std::vector<std::string> items;
+    std::string item;
+    for (const char* p = raw ? raw : ""; ; ++p) {
+      if (*p == ',' || *p == '\0') {
+        if (!item.empty()) {
+          items.push_back(item);
+        }
+        item.clear();
+        if (*p == '\0') {
+          break;
+        }
+      }
+      else if (!std::isspace(static_cast<unsigned char>(*p))) {
+        item += *p;
+      }
+    }
+    return items;
+  }
+
+  // The stream a name prefix (the name without its frame and segment, or without
+  // the discovery marker) belongs to. A single-stream producer serves any prefix
+  // under /LiveStream, as before multi-stream support.
+  Stream*
+  findStream(const Name& streamPrefix) const
+  {
+    auto it = m_streamsByPrefix.find(streamPrefix);
+    if (it != m_streamsByPrefix.end()) {
+      return it->second;
+    }
+    return m_streams.size() == 1 ? m_streams.front().get() : nullptr;
+  }
+
+  // The asymmetric modes sign with the default identity, whose key type is fixed
+  // when the driver generates it; warn if it does not match the selected mode.
+  void
+  checkSigningKey()
+  {
+    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    std::cout << "[" << timestamp << "] STARTUP: Signing mode: " << toString(m_signingMode) << std::endl;
+    if (!isAsymmetric(m_signingMode)) {
+      return;
+    }
+    try {
+      auto keyType = m_keyChain.getPib().getDefaultIdentity().getDefaultKey().getKeyType();
+      auto expected = m_signingMode == SigningMode::RSA ? KeyType::RSA : KeyType::EC;
+      if (keyType != expected) {
+        std::cerr << "[" << timestamp << "] WARNING: Default signing key does not match EXP_SIGNING="
+                  << toString(m_signingMode) << std::endl;
+      }
+    }
+    catch (const std::exception& e) {
+      std::cerr << "[" << timestamp << "] WARNING: No default signing identity: " << e.what() << std::endl;
+    }
+  }
+
+  void
+  onRegisterSuccess(const Name& prefix)
+  {
+    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    std::cout << "[" << timestamp << "] PREFIX: Successfully registered prefix: " << prefix << std::endl;
+    // /LiveStream is advertised once per process, by shard 0.
+    if (m_shard != 0 || m_isAdvertised) {
+      return;
+    }
+    m_isAdvertised = true;
+
+    // Now that the local filter is confirmed, advertise the prefix to the network.
+    std::cout << "[" << timestamp << "] PREFIX: Advertising prefix via NLSR" << std::endl;
+    m_nlsrControl->advertise(STREAM_ROOT, [this] (bool isSuccess) {
+      auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+      if (!isSuccess) {
+        std::cerr << "[" << timestamp << "] ERROR: Failed to advertise prefix via NLSR" << std::endl;
+        m_face.shutdown();
+      } else {
+        std::cout << "[" << timestamp << "] PREFIX: Successfully advertised prefix via NLSR" << std::endl;
+      }
+    });
+  }
+
+  void
+  onRegisterFailed(const Name& prefix, const std::string& reason)
+  {
+    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    std::cerr << "[" << timestamp << "] ERROR: Failed to register prefix '" << prefix
+              << "' with reason: " << reason << std::endl;
+    std::cerr << "[" << timestamp << "] ERROR: Shutting down face due to registration failure" << std::endl;
+    m_face.shutdown();
+  }
+
+  // This callback is triggered by the NetlinkListener. One event opens a new
+  // marking window and flood budget (see MarkingPolicy), spends it on the
+  // refresh burst, then on the parked Interests of every hosted stream in
+  // priority order.
+  void
+  onMobilityEvent()
+  {
+    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    std::cout << "[" << timestamp << "] MOBILITY: Producer mobility event triggered" << std::endl;
+    m_mobilityEventCount++;
+    openMarkBudget();
+    m_markWindowEnd = time::steady_clock::now() + m_markingPolicy.window;
+
+    if (m_enableOptoFlood) {
+      for (auto& stream : m_streams) {
+        sendMobilityRefresh(*stream);
+      }
+    }
+
+    // Oldest frame first, arrival order within a frame, across all streams; a
+    // stable sort or partition keeps that order within each priority class.
+    std::vector<PendingInterest*> parked;
+    for (auto& stream : m_streams) {
+      for (auto& pending : stream->pendingSlots) {
+        if (pending.id != 0) {
+          parked.push_back(&pending);
+        }
+      }
+    }
+    std::sort(parked.begin(), parked.end(), [] (const auto* a, const auto* b) {
+      return std::tie(a->frame, a->id) < std::tie(b->frame, b->id);
+    });
+    switch (m_markingPolicy.priority) {
+      case MarkingPolicy::Priority::OLDEST:
+        break;
+      case MarkingPolicy::Priority::NEWEST:
+        std::stable_sort(parked.begin(), parked.end(),
+                         [] (const auto* a, const auto* b) { return a->frame > b->frame; });
+        break;
+      case MarkingPolicy::Priority::SEGMENT0:
+        std::stable_partition(parked.begin(), parked.end(),
+                              [] (const auto* p) { return p->segment == 0; });
+        break;
+    }
+    // Marks go to the first Interests in priority order that the budget could
+    // cover; budget is spent only as marked Data are sent, so a marked Interest
+    // that expires unserved costs nothing.
+    uint64_t markable = markBudgetLeft();
+    size_t marked = 0;
+    for (auto* pending : parked) {
+      if (marked >= markable) {
+        break;
+      }
+      pending->markMobility = true;
+      pending->mobilitySeq = m_mobilityEventCount;
+      marked++;
+    }
+    std::cout << "[" << timestamp << "] MOBILITY: Total mobility events: " << m_mobilityEventCount << std::endl;
+    std::cout << "[" << timestamp << "] MOBILITY: Pending Interests marked: " << marked
+              << " of " << parked.size() << " across " << m_streams.size() << " streams" << std::endl;
+    std::cout << "[" << timestamp << "] MARKING: marked_sent=" << m_markedSent
+              << " unmarked_sent=" << m_unmarkedSent
+              << " budget_exhausted=" << m_markBudgetExhausted << std::endl;
+
+    // Start routing convergence now rather than when forwarders notice the move.
+    if (m_shard == 0 && m_isAdvertised) {
+      std::cout << "[" << timestamp << "] PREFIX: Re-advertising prefix via NLSR" << std::endl;
+      m_nlsrControl->readvertise(STREAM_ROOT);
+    }
+  }
+
+  // Flood-marked Data sent unsolicited right after a mobility event, so the
+  // path toward the new attachment point is rebuilt within one RTT instead of
+  // when the next parked frame is due: an announcement under the stream prefix,
+  // then fresh marked copies of the last EXP_MOBILITY_REFRESH_FRAMES frames.
+  void
+  sendMobilityRefresh(Stream& stream)
+  {
+    uint32_t mobilitySeq = static_cast<uint32_t>(m_mobilityEventCount);
+    if (!takeMarkBudget()) {
+      return;
+    }
+    Name announcement(stream.prefix);
+    announcement.append(MOBILITY_MARKER).appendSequenceNumber(m_mobilityEventCount);
+    sendData(*makeData(stream, announcement, true, mobilitySeq, 1_s));
+
+    // Newest frame first, and no more than the budget could still cover; the
+    // segments join the marked wave, which spends the budget across streams.
+    uint64_t edge = edgeNow(stream);
+    uint64_t frames = std::min<uint64_t>(m_mobilityRefreshFrames, edge + 1);
+    uint64_t markable = markBudgetLeft();
+    size_t queued = 0;
+    for (uint64_t i = 0; i < frames; ++i) {
+      uint64_t frame = edge - i;
+      int segmentCount = segmentsFor(stream, frame) + m_fecParity;
+      for (int segment = 0; segment < segmentCount && queued < markable; ++segment) {
+        Name name(stream.prefix);
+        name.appendVersion(frame).appendSegment(segment);
+        queueMarked(stream, frame, segment, makeSegmentData(stream, name, frame, segment, true, mobilitySeq),
+                    false);
+        queued++;
+      }
+    }
+    std::cout << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+              << "] MOBILITY: Refresh queued for " << stream.prefix << " (announcement + "
+              << queued << " segments of " << frames << " frames)" << std::endl;
+  }
+
+  size_t
+  pendingTotal() const
+  {
+    size_t total = 0;
+    for (const auto& stream : m_streams) {
+      total += stream->pendingCount;
+    }
+    return total;
+  }
+
+  static const char*
+  rejectReasonName(RejectReason reason)
+  {
+    switch (reason) {
+      case RejectReason::TOO_FAR_AHEAD:
+        return "too_far_ahead";
+      case RejectReason::TABLE_FULL:
+        return "table_full";
+    }
+    return "unknown";
+  }
+
+  // Refuse an Interest the pending table will not hold: with a network Nack
+  // (Congestion when full, NoRoute when too far ahead; EXP_REJECT_WITH=nack), or
+  // by default with an application Nack, a Data of ContentType Nack that carries
+  // the reason and the live edge so the consumer can resynchronise. The Nack
+  // Data has zero freshness so it never answers a later Interest from a cache.
+  void
+  rejectInterest(const Stream& stream, const Interest& interest, RejectReason reason)
+  {
+    m_rejects[static_cast<size_t>(reason)]++;
+    // Rejections come in bursts under overload: logged through the binary event
+    // log when it is on, like the other per-packet events.
+    if (!m_eventLog ||
+        !m_eventLog->record(EventType::INTEREST_REJECTED, interest.getName(), 0, 0, 0, 0,
+                            static_cast<uint16_t>(reason))) {
+      std::cout << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                << "] INTEREST: Rejected (" << rejectReasonName(reason) << ") Name: "
+                << interest.getName() << std::endl;
+    }
+
+    if (m_rejectWithNack) {
+      lp::Nack nack(interest);
+      nack.setReason(reason == RejectReason::TABLE_FULL ? lp::NackReason::CONGESTION
+                                                        : lp::NackReason::NO_ROUTE);
+      m_face.put(nack);
+      return;
+    }
+    auto data = make_shared<Data>(interest.getName());
+    data->setContentType(tlv::ContentType_Nack);
+    data->setFreshnessPeriod(0_ms);
+    data->setContent(std::string_view(rejectReasonName(reason)));
+    MetaInfo metaInfo = data->getMetaInfo();
+    metaInfo.addAppMetaInfo(makeNonNegativeIntegerBlock(TLV_LIVE_EDGE, edgeNow(stream)));
+    data->setMetaInfo(metaInfo);
+    sign(*data);
+    sendData(*data);
+  }
+
+  // Open the flood budget of this shard's latest mobility event, unless another
+  // shard already opened it for the same event.
+  void
+  openMarkBudget()
+  {
+    std::lock_guard<std::mutex> lock(m_shared.markBudgetMutex);
+    if (m_shared.markBudgetEvent < m_mobilityEventCount) {
+      m_shared.markBudgetEvent = m_mobilityEventCount;
+      m_shared.markBudgetLeft = m_markingPolicy.budget > 0 ? m_markingPolicy.budget
+                                                           : std::numeric_limits<uint64_t>::max();
+    }
+  }
+
+  uint64_t
+  markBudgetLeft() const
+  {
+    std::lock_guard<std::mutex> lock(m_shared.markBudgetMutex);
+    return m_shared.markBudgetLeft;
+  }
+
+  // Whether another marked Data fits in the current event's flood budget; if so,
+  // it is counted against it. Budget is spent as the marked wave is sent (see
+  // flushMarkedWave), and given back if the paced transmit queue drops it.
+  bool
+  takeMarkBudget()
+  {
+    std::lock_guard<std::mutex> lock(m_shared.markBudgetMutex);
+    if (m_shared.markBudgetLeft == 0) {
+      return false;
+    }
+    if (--m_shared.markBudgetLeft == 0) {
+      m_markBudgetExhausted++;
+      std::cout << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                << "] MARKING: flood budget of " << m_markingPolicy.budget
+                << " exhausted for mobility event " << m_mobilityEventCount << std::endl;
+    }
+    return true;
+  }
+
+  void
+  refundMarkBudget()
+  {
+    std::lock_guard<std::mutex> lock(m_shared.markBudgetMutex);
+    if (m_shared.markBudgetEvent == m_mobilityEventCount &&
+        m_shared.markBudgetLeft < std::numeric_limits<uint64_t>::max()) {
+      m_shared.markBudgetLeft++;
+    }
+  }
+
+  // Interests that arrive within the marking window after a mobility event are
+  // marked too, in arrival order, while the budget lasts.
+  bool
+  shouldMarkArrival()
+  {
+    return m_mobilityEventCount > 0 && time::steady_clock::now() < m_markWindowEnd &&
+           markBudgetLeft() > 0;
+  }
+
+  // Whether a Data carries OptoFlood markers, i.e. counts as marked once sent.
+  static bool
+  hasMobilityMarkers(const Data& data)
+  {
+#ifdef SOLUTION_ENABLED
+    static const uint32_t floodIdType = optoflood::makeFloodIdBlock(0).type();
+    return data.getMetaInfo().findAppMetaInfo(floodIdType) != nullptr;
+#else
+    (void)data;
+    return false;
+#endif
+  }
+
+  // Arm the stream's release timer for the earliest instant at which parked work
+  // exists: the exact boundary startTime + N*framePeriod of the lowest parked
+  // frame N, or the next Interest expiry if that comes first. Targets are
+  // absolute, so per-tick processing time never accumulates into drift, and
+  // nothing is armed while no Interest is parked.
+  void
+  armRelease(Stream& stream)
+  {
+    // Surface the earliest live frame and expiry; entries of Interests already
+    // served or expired are stale.
+    while (!stream.releaseHeap.empty() && !isPending(stream, stream.releaseHeap.top())) {
+      stream.releaseHeap.pop();
+    }
+    while (!stream.expiryHeap.empty() && !isPending(stream, stream.expiryHeap.top())) {
+      stream.expiryHeap.pop();
+    }
+
+    if (stream.pendingCount == 0) {
+      stream.releaseEvent.cancel();
+      stream.releaseArmed = false;
+      return;
+    }
+
+    // Interests held for the produce-ahead pipeline are released by its
+    // completion instead, and are not in the release heap.
+    auto target = time::steady_clock::time_point::max();
+    bool isFrameBoundary = false;
+    if (!stream.releaseHeap.empty()) {
+      target = frameStart(stream, stream.releaseHeap.top().frame);
+      isFrameBoundary = true;
+    }
+    if (!stream.expiryHeap.empty() && stream.expiryHeap.top().expiry < target) {
+      target = stream.expiryHeap.top().expiry;
+      isFrameBoundary = false;
+    }
+
+    if (stream.releaseArmed && stream.releaseTarget == target) {
+      return;
+    }
+    stream.releaseArmed = true;
+    stream.releaseTarget = target;
+    stream.releaseIsFrameBoundary = isFrameBoundary;
+
+    auto delay = target - time::steady_clock::now();
+    if (delay.count() < 0) {
+      delay = delay.zero();
+    }
+    stream.releaseEvent = m_scheduler.schedule(delay, [this, &stream] { onReleaseTimer(stream); });
+  }
+
+  void
+  onReleaseTimer(Stream& stream)
+  {
+    stream.releaseArmed = false;
+    if (stream.releaseIsFrameBoundary) {
+      recordReleaseJitter(time::steady_clock::now() - stream.releaseTarget);
+    }
+    advanceLiveEdgeAndServe(stream);
+  }
+
+  // Release jitter is the lateness of the timer against the frame boundary it
+  // was armed for; it bounds how late a parked frame leaves the producer.
+  // Aggregated over all streams.
+  void
+  recordReleaseJitter(time::nanoseconds lateness)
+  {
+    m_releaseLateness.record(lateness);
+    auto& st = m_releaseJitter;
+    st.count++;
+    st.sumNs += static_cast<uint64_t>(lateness.count());
+    st.maxNs = std::max<uint64_t>(st.maxNs, lateness.count());
+    st.minNs = st.count == 1 ? lateness.count() : std::min<uint64_t>(st.minNs, lateness.count());
+
+    if (st.count % ReleaseJitterStats::REPORT_EVERY == 0) {
+      std::cout << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                << "] SCHED: release jitter over " << st.count << " releases"
+                << " mean_us=" << st.sumNs / st.count / 1000.0
+                << " min_us=" << st.minNs / 1000.0
+                << " max_us=" << st.maxNs / 1000.0 << std::endl;
+    }
+  }
+
+  // Encode and sign one Data packet for a requested name. Every Data carries the
+  // stream's current live edge (TLV_LIVE_EDGE) so consumers track it via feedback.
+  // Mobility-marked Data additionally carry OptoFlood markers so the modified
+  // forwarder floods them along the FIB to refresh the path.
+  shared_ptr<Data>
+  makeData(const Stream& stream, const Name& name, bool markMobility, uint32_t mobilitySeq,
+           time::milliseconds freshness)
+  {
+    auto data = makeUnsignedData(stream, name, edgeNow(stream), freshness);
+    attachMobilityMarkers(*data, markMobility, mobilitySeq);
+    sign(*data);
+    return data;
+  }
+
+  // As makeData, for segment <segment> of frame <frame>. In manifest mode,
+  // segment 0 carries the frame manifest and unmarked segments 1..K-1 are
+  // digest-only; a marked segment is re-signed in full because its markers
+  // change its digest.
+  shared_ptr<Data>
+  makeSegmentData(Stream& stream, const Name& name, uint64_t frame, uint64_t segment,
+                  bool markMobility, uint32_t mobilitySeq)
+  {
+    bool isMarked = m_enableOptoFlood && markMobility;
+    // Templates cover the plain layout only: no markers, manifest, parity or
+    // traced sizes, and a name the template rebuilds byte for byte (minimal
+    // version and segment encodings), or the reply would not match the Interest.
+    if (m_dataTemplates && !isMarked && !m_frameManifest && m_fecParity == 0 && m_shared.trace == nullptr &&
+        name.size() == stream.prefix.size() + 2 && stream.prefix.isPrefixOf(name) &&
+        name.get(-2).value_size() == encodingWidth(frame) &&
+        name.get(-1).value_size() == encodingWidth(segment)) {
+      return makeTemplateSegment(stream, frame, segment);
+    }
+    if (m_frameManifest && segment > 0 && !isMarked) {
+      return makeDigestSegment(stream, name, frame, m_keyChain);
+    }
+
+    auto data = makeUnsignedData(stream, name, edgeNow(stream), 10_s);
+    if (m_frameManifest && segment == 0) {
+      // The digest segments the manifest lists are kept for serving, so each is
+      // built once per frame.
+      auto covered = addFrameManifest(stream, *data, frame, m_keyChain, stream.replyCache.get());
+      for (size_t i = 0; i < covered.size(); ++i) {
+        stream.replyCache->insert(frame, i + 1, std::move(covered[i]));
+      }
+    }
+    attachMobilityMarkers(*data, markMobility, mobilitySeq);
+    sign(*data);
+    return data;
+  }
+
+  // As makeSegmentData, by patching the frame's template: the version, segment,
+  // live-edge and content bytes are overwritten in place, the signed portion is
+  // signed as is, and the Data TLV is assembled around it in one buffer. The
+  // packet is then decoded once, as Face::put takes a Data.
+  shared_ptr<Data>
+  makeTemplateSegment(Stream& stream, uint64_t frame, uint64_t segment)
+  {
+    auto& tmpl = stream.templates[encodingWidthIndex(frame) * 4 + encodingWidthIndex(segment)];
+    if (tmpl == nullptr) {
+      tmpl = buildTemplate(stream, frame, segment);
+    }
+
+    Buffer& wire = stream.templateScratch;
+    wire.assign(tmpl->signedPortion.begin(), tmpl->signedPortion.end());
+    writeBigEndian(&wire[tmpl->versionOffset], frame, encodingWidth(frame));
+    writeBigEndian(&wire[tmpl->segmentOffset], segment, encodingWidth(segment));
+    writeBigEndian(&wire[tmpl->edgeOffset], edgeNow(stream), 8);
+    auto content = payloadFor(frame, segment, stream.segmentsPerFrame);
+    std::copy_n(content.data(), std::min<size_t>(content.size(), tmpl->contentSize),
+                &wire[tmpl->contentOffset]);
+
+    auto signStart = time::steady_clock::now();
+    auto signatureValue = signBytes(make_span(wire.data(), wire.size()));
+    m_stages.sign.record(time::steady_clock::now() - signStart);
+    EncodingBuffer encoder(wire.size() + signatureValue->size() + 16, 0);
+    size_t length = prependBinaryBlock(encoder, tlv::SignatureValue, *signatureValue);
+    length += encoder.prependBytes(make_span(wire.data(), wire.size()));
+    encoder.prependVarNumber(length);
+    encoder.prependVarNumber(tlv::Data);
+    return make_shared<Data>(encoder.block());
+  }
+
+  // Build a template from a reply encoded and signed the regular way, so its
+  // layout and SignatureInfo are exactly those of the non-template path.
+  std::unique_ptr<DataTemplate>
+  buildTemplate(const Stream& stream, uint64_t frame, uint64_t segment)
+  {
+    Data data(Name(stream.prefix).appendVersion(frame).appendSegment(segment));
+    data.setFreshnessPeriod(10_s);
+    data.setFinalBlock(name::Component::fromSegment(stream.segmentsPerFrame - 1));
+    data.setContent(payloadFor(frame, segment, stream.segmentsPerFrame));
+    MetaInfo metaInfo = data.getMetaInfo();
+    uint8_t edge[8] = {};
+    metaInfo.addAppMetaInfo(makeBinaryBlock(TLV_LIVE_EDGE, make_span(edge, sizeof(edge))));
+    data.setMetaInfo(metaInfo);
+    m_keyChain.sign(data, m_signingInfo);
+
+    const Block& wire = data.wireEncode();
+    wire.parse();
+    auto signedRange = data.extractSignedRanges().front();
+    const uint8_t* begin = signedRange.data();
+
+    auto tmpl = std::make_unique<DataTemplate>();
+    tmpl->signedPortion.assign(begin, begin + signedRange.size());
+    const Block& name = wire.get(tlv::Name);
+    name.parse();
+    tmpl->versionOffset = name.elements().end()[-2].value() - begin;
+    tmpl->segmentOffset = name.elements().end()[-1].value() - begin;
+    const Block& meta = wire.get(tlv::MetaInfo);
+    meta.parse();
+    tmpl->edgeOffset = meta.find(TLV_LIVE_EDGE)->value() - begin;
+    const Block& content = wire.get(tlv::Content);
+    tmpl->contentOffset = content.value() - begin;
+    tmpl->contentSize = content.value_size();
+    return tmpl;
+  }
+
+  // Sign with the configured mode on the event-loop thread, timing the call.
+  void
+  sign(Data& data)
+  {
+    auto start = time::steady_clock::now();
+    m_keyChain.sign(data, m_signingInfo);
+    m_stages.sign.record(time::steady_clock::now() - start);
+  }
+
+  // Signature value over a template's signed portion, as KeyChain::sign would
+  // compute it for the configured mode.
+  ConstBufferPtr
+  signBytes(span<const uint8_t> bytes)
+  {
+    switch (m_signingMode) {
+      case SigningMode::ECDSA:
+      case SigningMode::RSA:
+        return m_keyChain.getTpm().sign({bytes}, m_signingKeyName, DigestAlgorithm::SHA256);
+      case SigningMode::HMAC:
+        return m_hmacSigner->sign(bytes);
+      case SigningMode::DIGEST:
+        return util::Sha256::computeDigest(bytes);
+    }
+    return nullptr;
+  }
+
+  // Minimal NonNegativeInteger encoding widths, as used for name components.
+  static size_t
+  encodingWidth(uint64_t value)
+  {
+    return value <= 0xFF ? 1 : value <= 0xFFFF ? 2 : value <= 0xFFFFFFFF ? 4 : 8;
+  }
+
+  static size_t
+  encodingWidthIndex(uint64_t value)
+  {
+    size_t width = encodingWidth(value);
+    return width == 1 ? 0 : width == 2 ? 1 : width == 4 ? 2 : 3;
+  }
+
+  static void
+  writeBigEndian(uint8_t* out, uint64_t value, size_t width)
+  {
+    for (size_t i = 0; i < width; ++i) {
+      out[i] = static_cast<uint8_t>(value >> (8 * (width - 1 - i)));
+    }
+  }
+
+  void
+  attachMobilityMarkers(Data& data, bool markMobility, uint32_t mobilitySeq)
+  {
+#ifdef SOLUTION_ENABLED
+    if (m_enableOptoFlood && markMobility) {
+      MetaInfo metaInfo = data.getMetaInfo();
+      uint64_t floodId = ++m_shared.floodIdSeq;
+      metaInfo.addAppMetaInfo(optoflood::makeFloodIdBlock(floodId));
+      metaInfo.addAppMetaInfo(optoflood::makeNewFaceSeqBlock(mobilitySeq));
+      data.setMetaInfo(metaInfo);
+      if (!m_eventLog ||
+          !m_eventLog->record(EventType::MOBILITY_MARKED, data.getName(), floodId, mobilitySeq)) {
+        std::cout << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                  << "] DATA: Attaching OptoFlood mobility markers"
+                  << " NewFaceSeq: " << mobilitySeq
+                  << " FloodId: " << floodId << std::endl;
+      }
+    }
+#endif
+  }
+
+  // A manifest-covered segment. Its live-edge stamp is pinned to its own frame
+  // so the encoding, and hence the digest listed in the manifest, is the same
+  // whenever it is (re)produced; the current edge travels in segment 0.
+  shared_ptr<Data>
+  makeDigestSegment(const Stream& stream, const Name& name, uint64_t frame,
+                    KeyChain& keyChain) const
+  {
+    auto data = makeUnsignedData(stream, name, frame, 10_s);
+    keyChain.sign(*data, security::signingWithSha256());
+    return data;
+  }
+
+  // Add the manifest of segments 1.. of the frame to its segment 0 and return
+  // those segments, in order, for the caller to serve. Segments already in
+  // @p cache are reused instead of rebuilt; workers pass none.
+  std::vector<shared_ptr<const Data>>
+  addFrameManifest(const Stream& stream, Data& head, uint64_t frame, KeyChain& keyChain,
+                   const ReplyCache* cache = nullptr) const
+  {
+    Name prefix = head.getName().getPrefix(-1);
+    Block manifest(TLV_FRAME_MANIFEST);
+    int segmentCount = segmentsFor(stream, frame) + m_fecParity;
+    std::vector<shared_ptr<const Data>> covered;
+    covered.reserve(segmentCount > 0 ? segmentCount - 1 : 0);
+    for (int segment = 1; segment < segmentCount; ++segment) {
+      Name name = Name(prefix).appendSegment(segment);
+      shared_ptr<const Data> data = cache != nullptr ? cache->find(frame, segment) : nullptr;
+      if (data == nullptr || data->getName() != name) {
+        data = makeDigestSegment(stream, name, frame, keyChain);
+      }
+      manifest.push_back(data->getFullName().get(-1));
+      covered.push_back(std::move(data));
+    }
+    manifest.encode();
+
+    MetaInfo metaInfo = head.getMetaInfo();
+    metaInfo.addAppMetaInfo(manifest);
+    head.setMetaInfo(metaInfo);
+    return covered;
+  }
+
+  // Build the unsigned part common to every reply. Touches no Producer state
+  // beyond configuration, so the signing workers may call it.
+  shared_ptr<Data>
+  makeUnsignedData(const Stream& stream, const Name& name, uint64_t edge,
+                   time::milliseconds freshness) const
+  {
+    bool isSegment = name.size() >= 2 && name.get(-1).isSegment() && name.get(-2).isVersion();
+    uint64_t frame = isSegment ? name.get(-2).toVersion() : 0;
+    uint64_t segment = isSegment ? name.get(-1).toSegment() : 0;
+    int segmentCount = isSegment ? segmentsFor(stream, frame) : stream.segmentsPerFrame;
+
+    auto data = make_shared<Data>(name);
+    data->setFreshnessPeriod(freshness);
+    // FinalBlockId advertises the last segment index of the frame: K-1, or
+    // K+R-1 with parity.
+    data->setFinalBlock(name::Component::fromSegment(segmentCount + m_fecParity - 1));
+    bool isParity = isSegment && segment >= static_cast<uint64_t>(segmentCount);
+    if (isParity) {
+      std::vector<span<const uint8_t>> sources;
+      for (int i = 0; i < segmentCount; ++i) {
+        sources.push_back(payloadFor(frame, i, segmentCount));
+      }
+      auto parity = fec::encodeParity(sources, m_fecParity, segment - segmentCount);
+      data->setContent(make_span(parity.data(), parity.size()));
+    }
+    else if (isSegment) {
+      data->setContent(payloadFor(frame, segment, segmentCount));
+    }
+    else {
+      data->setContent(MARKER_CONTENT);
+    }
+
+    MetaInfo metaInfo = data->getMetaInfo();
+    metaInfo.addAppMetaInfo(makeNonNegativeIntegerBlock(TLV_LIVE_EDGE, edge));
+    if (m_fecParity > 0 && isSegment) {
+      metaInfo.addAppMetaInfo(makeNonNegativeIntegerBlock(fec::TLV_FEC_PARITY, m_fecParity));
+    }
+    if (isParity) {
+      metaInfo.addAppMetaInfo(makeNonNegativeIntegerBlock(fec::TLV_FEC_FRAME_BYTES,
+                                                          frameBytesFor(frame, segmentCount)));
+    }
+    data->setMetaInfo(metaInfo);
+    return data;
+  }
+
+  // Content of a segment: its mapped bytes when a payload source is configured,
+  // else the fixed marker. Under a frame trace, the frame's bytes are cut into
+  // full segments and the last one carries the remainder.
+  span<const uint8_t>
+  payloadFor(uint64_t frame, uint64_t segment, int segmentCount) const
+  {
+    if (m_shared.payload == nullptr) {
+      return make_span(reinterpret_cast<const uint8_t*>(MARKER_CONTENT.data()), MARKER_CONTENT.size());
+    }
+    size_t segmentBytes = m_shared.payload->segmentBytes();
+    size_t bytes = segmentBytes;
+    if (m_shared.trace != nullptr) {
+      size_t frameBytes = m_shared.trace->frameBytes(frame);
+      size_t offset = segment * segmentBytes;
+      bytes = offset < frameBytes ? std::min(segmentBytes, frameBytes - offset) : 0;
+    }
+    return m_shared.payload->segment(frame * segmentCount + segment, bytes);
+  }
+
+  // Source bytes of a frame, as the consumer needs them to trim recovered
+  // segments (TLV_FEC_FRAME_BYTES).
+  size_t
+  frameBytesFor(uint64_t frame, int segmentCount) const
+  {
+    size_t bytes = 0;
+    for (int i = 0; i < segmentCount; ++i) {
+      bytes += payloadFor(frame, i, segmentCount).size();
+    }
+    return bytes;
+  }
+
+  // Segment count K of a frame: from its traced size under a frame trace, else
+  // the stream's fixed K. Advertised per frame through FinalBlockId.
+  int
+  segmentsFor(const Stream& stream, uint64_t frame) const
+  {
+    if (m_shared.trace == nullptr) {
+      return stream.segmentsPerFrame;
+    }
+    size_t segmentBytes = m_shared.payload->segmentBytes();
+    size_t frameBytes = m_shared.trace->frameBytes(frame);
+    return static_cast<int>(std::max<size_t>(1, (frameBytes + segmentBytes - 1) / segmentBytes));
+  }
+
+  int
+  maxSegments(const Stream& stream) const
+  {
+    if (m_shared.trace == nullptr) {
+      return stream.segmentsPerFrame;
+    }
+    size_t segmentBytes = m_shared.payload->segmentBytes();
+    return static_cast<int>(std::max<size_t>(1, (m_shared.trace->maxFrameBytes() + segmentBytes - 1) /
+                                                 segmentBytes));
+  }
+
+  // Produce-ahead pipeline: at the boundary of frame N, all K segments of N are
+  // built, signed and encoded on the worker pool, then handed back to the event
+  // loop through the stream's reply cache, so parked Interests for N are
+  // answered with a plain put instead of waiting for a signature.
+  void
+  scheduleProduction(Stream& stream, uint64_t frame)
+  {
+    auto delay = frameStart(stream, frame) - time::steady_clock::now();
+    if (delay.count() < 0) {
+      delay = delay.zero();
+    }
+    stream.productionEvent = m_scheduler.schedule(delay, [this, &stream, frame] {
+      produceFrame(stream, frame);
+    });
+  }
+
+  void
+  produceFrame(Stream& stream, uint64_t frame)
+  {
+    // Never fall further behind than the live edge: skip to the current frame.
+    frame = std::max(frame, edgeNow(stream));
+    scheduleProduction(stream, frame + 1);
+
+    if (stream.framesInFlight.size() >= static_cast<size_t>(MAX_FRAMES_IN_FLIGHT)) {
+      m_pipelineFramesSkipped++;
+      std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                << "] PIPELINE: workers saturated, frame " << frame << " of " << stream.prefix
+                << " left to on-demand signing (skipped " << m_pipelineFramesSkipped << ")"
+                << std::endl;
+      return;
+    }
+    int segmentCount = segmentsFor(stream, frame) + m_fecParity;
+    stream.framesInFlight[frame] = segmentCount;
+
+    // In manifest mode one job builds the whole frame: the digest segments come
+    // out of building the manifest.
+    int jobs = m_frameManifest ? 1 : segmentCount;
+    for (int segment = 0; segment < jobs; ++segment) {
+      Name name(stream.prefix);
+      name.appendVersion(frame).appendSegment(segment);
+      boost::asio::post(*m_signPool, [this, &stream, name, frame, segment] {
+        // KeyChain is not thread-safe: every worker signs with its own instance.
+        thread_local KeyChain workerKeyChain;
+        auto data = makeUnsignedData(stream, name, frame, 10_s);
+        std::vector<shared_ptr<const Data>> covered;
+        if (m_frameManifest) {
+          covered = addFrameManifest(stream, *data, frame, workerKeyChain);
+        }
+        workerKeyChain.sign(*data, m_signingInfo);
+        data->wireEncode();
+        boost::asio::post(m_ioContext, [this, &stream, data, covered = std::move(covered), frame, segment] {
+          onSegmentProduced(stream, frame, segment, data);
+          for (size_t i = 0; i < covered.size(); ++i) {
+            onSegmentProduced(stream, frame, i + 1, covered[i]);
+          }
+        });
+      });
+    }
+  }
+
+  void
+  onSegmentProduced(Stream& stream, uint64_t frame, uint64_t segment, shared_ptr<const Data> data)
+  {
+    stream.replyCache->insert(frame, segment, std::move(data));
+
+    auto it = stream.framesInFlight.find(frame);
+    if (it == stream.framesInFlight.end() || --it->second > 0) {
+      return;
+    }
+    stream.framesInFlight.erase(it);
+    // Parked Interests for this frame were held back while it was in flight.
+    advanceLiveEdgeAndServe(stream);
+  }
+
+  void
+  waitForSignal()
+  {
+    m_signals.async_wait([this] (const boost::system::error_code& error, int signal) {
+      if (error) {
+        return;
+      }
+      dumpStageHistograms();
+      if (signal == SIGUSR1) {
+        waitForSignal();
+      }
+      else {
+        stop();
+      }
+    });
+  }
+
+  void
+  dumpStageHistograms() const
+  {
+    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    m_stages.forEach([&] (const char* stage, const LatencyHistogram& histogram) {
+      std::ostringstream line;
+      histogram.writeSummary(line);
+      std::cout << "[" << timestamp << "] HIST: shard=" << m_shard << " stage=" << stage
+                << " " << line.str() << std::endl;
+    });
+  }
+
+  void
+  startStatsSocket(const std::string& path)
+  {
+    using boost::asio::local::stream_protocol;
+    ::unlink(path.data());
+    try {
+      m_statsAcceptor.open(stream_protocol());
+      m_statsAcceptor.bind(stream_protocol::endpoint(path));
+      m_statsAcceptor.listen();
+    }
+    catch (const boost::system::system_error& e) {
+      std::cerr << "ERROR: Failed to open stats socket " << path << ": " << e.what() << std::endl;
+      return;
+    }
+    std::cout << "Stats socket listening on " << path << std::endl;
+    acceptStatsClient();
+  }
+
+  void
+  acceptStatsClient()
+  {
+    using boost::asio::local::stream_protocol;
+    m_statsAcceptor.async_accept([this] (const boost::system::error_code& error,
+                                         stream_protocol::socket socket) {
+      if (error == boost::asio::error::operation_aborted) {
+        return;
+      }
+      if (!error) {
+        auto client = std::make_shared<stream_protocol::socket>(std::move(socket));
+        auto text = std::make_shared<std::string>(statsText(true));
+        boost::asio::async_write(*client, boost::asio::buffer(*text),
+                                 [client, text] (const boost::system::error_code&, size_t) {});
+      }
+      acceptStatsClient();
+    });
+  }
+
+  // This shard's counters, pending-table sizes and, with @p withHistograms,
+  // latency histograms in OpenMetrics text format. The histograms alone run to
+  // well over one NDN packet, so only the stats socket carries them.
+  std::string
+  statsText(bool withHistograms) const
+  {
+    std::ostringstream os;
+    std::string shard = "shard=\"" + std::to_string(m_shard) + "\"";
+    auto counter = [&] (const char* name, const char* help, uint64_t value) {
+      os << "# TYPE producer_" << name << " counter\n"
+         << "# HELP producer_" << name << " " << help << "\n"
+         << "producer_" << name << "_total{" << shard << "} " << value << "\n";
+    };
+    counter("interests", "Interests received", m_interestCount);
+    counter("data_sent", "Data sent", m_dataCount);
+    counter("reply_cache_hits", "Replies served from the reply cache", m_replyCacheHits);
+    counter("mobility_events", "Mobility events handled", m_mobilityEventCount);
+    counter("marked_data", "Data sent with OptoFlood mobility markers", m_markedSent);
+    counter("unmarked_data", "Data sent without OptoFlood mobility markers", m_unmarkedSent);
+    counter("mark_budget_exhausted", "Mobility events whose flood budget ran out",
+            m_markBudgetExhausted);
+    counter("pipeline_frames_skipped", "Frames left to on-demand signing", m_pipelineFramesSkipped);
+    counter("tx_batches", "End-of-tick transmit batches", m_txBatchStats.batches);
+    counter("tx_queue_dropped", "Replies dropped from the full paced transmit queue", m_txQueueDropped);
+
+    os << "# TYPE producer_rejected_interests counter\n"
+       << "# HELP producer_rejected_interests Interests refused by pending-table admission\n";
+    for (auto reason : {RejectReason::TOO_FAR_AHEAD, RejectReason::TABLE_FULL}) {
+      os << "producer_rejected_interests_total{" << shard << ",reason=\"" << rejectReasonName(reason)
+         << "\"} " << m_rejects[static_cast<size_t>(reason)] << "\n";
+    }
+
+    if (m_fairServe) {
+      struct {
+        const char* name;
+        const char* help;
+        uint64_t DownstreamStats::*counter;
+      } downstreamCounters[] = {
+        {"interests", "Content Interests received", &DownstreamStats::interests},
+        {"parked", "Interests parked for a future frame", &DownstreamStats::parked},
+        {"rejected", "Interests refused by pending-table admission", &DownstreamStats::rejected},
+        {"served", "Interests answered", &DownstreamStats::served},
+      };
+      for (const auto& c : downstreamCounters) {
+        os << "# TYPE producer_downstream_" << c.name << " counter\n"
+           << "# HELP producer_downstream_" << c.name << " " << c.help << ", per downstream face\n";
+        for (const auto& [face, stats] : m_downstreams) {
+          os << "producer_downstream_" << c.name << "_total{" << shard << ",face=\"" << face << "\"} "
+             << stats.*c.counter << "\n";
+        }
+      }
+    }
+
+    os << "# TYPE producer_pending_interests gauge\n"
+       << "# HELP producer_pending_interests Interests parked for a future frame\n";
+    for (const auto& stream : m_streams) {
+      os << "producer_pending_interests{" << shard << ",stream=\"" << stream->prefix << "\"} "
+         << stream->pendingCount << "\n";
+    }
+    if (!withHistograms) {
+      os << "# EOF\n";
+      return os.str();
+    }
+
+    os << "# TYPE producer_parked_latency_seconds histogram\n"
+       << "# HELP producer_parked_latency_seconds Interest arrival to Data sent, parked Interests\n";
+    m_parkedLatency.writeOpenMetrics(os, "producer_parked_latency_seconds", shard);
+    os << "# TYPE producer_release_lateness_seconds histogram\n"
+       << "# HELP producer_release_lateness_seconds Release timer lateness against the frame boundary\n";
+    m_releaseLateness.writeOpenMetrics(os, "producer_release_lateness_seconds", shard);
+    os << "# TYPE producer_stage_seconds histogram\n"
+       << "# HELP producer_stage_seconds Time spent per hot-path stage\n";
+    m_stages.forEach([&] (const char* stage, const LatencyHistogram& histogram) {
+      histogram.writeOpenMetrics(os, "producer_stage_seconds",
+                                 shard + ",stage=\"" + stage + "\"");
+    });
+    os << "# EOF\n";
+    return os.str();
+  }
+
+  // The _stats reply. Many streams or downstreams can still outgrow one packet:
+  // the text is then cut at a line boundary, keeping the closing "# EOF".
+  shared_ptr<Data>
+  makeStatsData(const Name& name)
+  {
+    static const std::string eof = "# EOF\n";
+    std::string text = statsText(false);
+    auto data = make_shared<Data>(name);
+    data->setFreshnessPeriod(0_ms);
+    data->setContent(std::string_view(text));
+    sign(*data);
+    size_t wireSize = data->wireEncode().size();
+    if (wireSize > MAX_NDN_PACKET_SIZE) {
+      size_t excess = wireSize - MAX_NDN_PACKET_SIZE;
+      size_t keep = text.size() > excess + eof.size() ? text.size() - excess - eof.size() : 0;
+      size_t cut = text.rfind('\n', keep > 0 ? keep - 1 : 0);
+      text.resize(cut == std::string::npos ? 0 : cut + 1);
+      text += eof;
+      std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                << "] WARNING: _stats reply truncated to fit one packet; "
+                << "the stats socket has the full text" << std::endl;
+      data = make_shared<Data>(name);
+      data->setFreshnessPeriod(0_ms);
+      data->setContent(std::string_view(text));
+      sign(*data);
+    }
+    return data;
+  }
+
+  // Hold a Data until the end of the current event-loop tick, so that every
+  // reply released by one timer or one Interest wave leaves back to back.
+  void
+  queueForBatch(const Data& data)
+  {
+    m_txBatch.push_back(data);
+    if (m_txBatch.size() == 1) {
+      boost::asio::post(m_ioContext, [this] { flushBatch(); });
+    }
+  }
+
+  // Put the queued packets to the Face in one run, through Face::put so each
+  // keeps the Face's NDNLPv2 encoding. The transport queues them in order
+  // behind the write in progress, with no other work interleaved.
+  void
+  flushBatch()
+  {
+    if (m_txBatch.empty()) {
+      return;
+    }
+    for (const auto& data : m_txBatch) {
+      putToFace(data);
+    }
+
+    auto& st = m_txBatchStats;
+    st.batches++;
+    st.packets += m_txBatch.size();
+    st.maxSize = std::max<uint64_t>(st.maxSize, m_txBatch.size());
+    m_txBatch.clear();
+    if (st.batches % TxBatchStats::REPORT_EVERY == 0) {
+      std::cout << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                << "] TX: " << st.packets << " Data in " << st.batches << " batches"
+                << " mean_size=" << static_cast<double>(st.packets) / st.batches
+                << " max_size=" << st.maxSize << std::endl;
+    }
+  }
+
+  static bool
+  isInFlight(const Stream& stream, uint64_t frame)
+  {
+    return stream.framesInFlight.count(frame) > 0;
+  }
+
+  // Send a reply that is not a frame segment (discovery, Nack, statistics,
+  // announcement); when paced, these leave ahead of any segment.
+  void
+  sendData(const Data& data)
+  {
+    if (m_pacingBytesPerSec > 0) {
+      enqueueTx(data, false, 0, 0);
+    }
+    else {
+      transmit(data);
+    }
+  }
+
+  void
+  sendSegment(const Stream& stream, uint64_t frame, uint64_t segment, const Data& data)
+  {
+    if (m_pacingBytesPerSec > 0) {
+      uint64_t edge = edgeNow(stream);
+      enqueueTx(data, true, edge - std::min(edge, frame), segment);
+    }
+    else {
+      transmit(data);
+    }
+  }
+
+  // Paced transmit path: replies wait in a priority queue, freshest frame first
+  // and segment 0 before the rest of a frame, so after a hand-off the live edge
+  // is not queued behind a backlog of stale frames. The queue is drained at the
+  // end of the tick that filled it, once a whole release wave is ordered.
+  void
+  enqueueTx(const Data& data, bool isSegment, uint64_t age, uint64_t segment)
+  {
+    m_txQueue.insert(TxEntry{isSegment, age, segment, ++m_txSeq, make_shared<Data>(data),
+                             time::steady_clock::now()});
+    if (m_txQueue.size() > m_pacingQueueCap) {
+      // Full: the least urgent reply, the oldest frame's last segment, is dropped.
+      auto last = std::prev(m_txQueue.end());
+      if (m_enableOptoFlood && hasMobilityMarkers(*last->data)) {
+        refundMarkBudget();
+      }
+      m_txQueue.erase(last);
+      m_txQueueDropped++;
+    }
+    if (!m_txDrainPending) {
+      m_txDrainPending = true;
+      boost::asio::post(m_ioContext, [this] { drainTxQueue(); });
+    }
+  }
+
+  // Token bucket: EXP_PACING_MBPS refills it, EXP_PACING_BURST_BYTES caps it.
+  // A reply leaves once the bucket holds its size (or is full, for a reply
+  // larger than the bucket); otherwise the drain resumes when it will.
+  void
+  drainTxQueue()
+  {
+    m_txDrainPending = false;
+    auto now = time::steady_clock::now();
+    double elapsed = time::duration_cast<time::nanoseconds>(now - m_tokensUpdated).count() / 1e9;
+    m_tokens = std::min(m_pacingBurstBytes, m_tokens + elapsed * m_pacingBytesPerSec);
+    m_tokensUpdated = now;
+
+    while (!m_txQueue.empty()) {
+      auto head = m_txQueue.begin();
+      double size = static_cast<double>(head->data->wireEncode().size());
+      double needed = std::min(size, m_pacingBurstBytes);
+      if (m_tokens < needed) {
+        auto wait = time::nanoseconds(static_cast<int64_t>((needed - m_tokens) / m_pacingBytesPerSec * 1e9) + 1);
+        m_txDrainPending = true;
+        m_txPacingEvent = m_scheduler.schedule(wait, [this] { drainTxQueue(); });
+        return;
+      }
+      m_tokens -= size;
+      m_stages.queued.record(now - head->queued);
+      transmit(*head->data);
+      m_txQueue.erase(head);
+    }
+  }
+
+  void
+  transmit(const Data& data)
+  {
+    // Face::put refuses an oversized packet by throwing from the event loop, which
+    // for a batched reply happens only at the end of the tick: drop it here instead.
+    if (data.wireEncode().size() > MAX_NDN_PACKET_SIZE) {
+      std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                << "] ERROR: Dropping oversized Data (" << data.wireEncode().size()
+                << " bytes) Name: " << data.getName() << std::endl;
+      return;
+    }
+    if (m_batchTx) {
+      queueForBatch(data);
+    }
+    else {
+      putToFace(data);
+    }
+    m_dataCount++;
+
+    if (m_eventLog &&
+        m_eventLog->record(EventType::DATA_SENT, data.getName(), data.wireEncode().size(),
+                           m_interestCount, m_dataCount, m_replyCacheHits)) {
+      return;
+    }
+    auto sendTimestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    std::cout << "[" << sendTimestamp << "] DATA: Sending response"
+              << " Size: " << data.wireEncode().size() << " bytes"
+              << " Name: " << data.getName() << std::endl;
+    std::cout << "[" << sendTimestamp << "] STATS: Total Interests: " << m_interestCount
+              << " Total Data sent: " << m_dataCount
+              << " Reply cache hits: " << m_replyCacheHits << std::endl;
+  }
+
+  // Where every reply leaves for NFD. Marked and unmarked replies are counted
+  // here, so one that is queued and then dropped or replaced is not.
+  void
+  putToFace(const Data& data)
+  {
+    m_face.put(data);
+    if (m_enableOptoFlood && hasMobilityMarkers(data)) {
+      m_markedSent++;
+    }
+    else {
+      m_unmarkedSent++;
+    }
+  }
+
+  // Hold a marked segment reply until the end of the tick. Replies released in
+  // one tick, from every stream, then spend the shared flood budget in marking
+  // priority order rather than in the order their streams happened to run.
+  void
+  queueMarked(Stream& stream, uint64_t frame, uint64_t segment, shared_ptr<const Data> data,
+              bool isSolicited)
+  {
+    m_markedWave.push_back(MarkedReply{&stream, frame, segment, std::move(data), isSolicited});
+    if (m_markedWave.size() == 1) {
+      boost::asio::post(m_ioContext, [this] { flushMarkedWave(); });
+    }
+  }
+
+  // Send the wave in priority order (see MarkingPolicy), newest frame by frame
+  // start time so streams of different periods compare. A reply the budget no
+  // longer covers goes out unmarked if an Interest asked for it, and is dropped
+  // if it was an unsolicited refresh.
+  void
+  flushMarkedWave()
+  {
+    auto wave = std::exchange(m_markedWave, {});
+    std::stable_sort(wave.begin(), wave.end(), [] (const auto& a, const auto& b) {
+      return frameStart(*a.stream, a.frame) < frameStart(*b.stream, b.frame);
+    });
+    switch (m_markingPolicy.priority) {
+      case MarkingPolicy::Priority::OLDEST:
+        break;
+      case MarkingPolicy::Priority::NEWEST:
+        std::stable_sort(wave.begin(), wave.end(), [] (const auto& a, const auto& b) {
+          return frameStart(*a.stream, a.frame) > frameStart(*b.stream, b.frame);
+        });
+        break;
+      case MarkingPolicy::Priority::SEGMENT0:
+        std::stable_partition(wave.begin(), wave.end(), [] (const auto& r) { return r.segment == 0; });
+        break;
+    }
+    for (const auto& reply : wave) {
+      if (takeMarkBudget()) {
+        sendSegment(*reply.stream, reply.frame, reply.segment, *reply.data);
+      }
+      else if (reply.isSolicited) {
+        serveSegment(*reply.stream, reply.data->getName(), reply.frame, reply.segment, false, 0);
+      }
+    }
+  }
+
+  // Answer a non-content name (live-edge discovery) with a freshly signed Data.
+  void
+  serveOne(const Stream& stream, const Name& name, bool markMobility, uint32_t mobilitySeq,
+           time::milliseconds freshness = 10_s)
+  {
+    sendData(*makeData(stream, name, markMobility, mobilitySeq, freshness));
+  }
+
+  // Answer a content name. Unmarked replies are looked up in, and added to, the
+  // stream's reply cache; marked replies are always freshly signed since each
+  // carries a unique FloodId, and they are not cached.
+  void
+  serveSegment(Stream& stream, const Name& name, uint64_t frame, uint64_t segment,
+               bool markMobility, uint32_t mobilitySeq)
+  {
+    bool isMarked = m_enableOptoFlood && markMobility;
+    if (isMarked && markBudgetLeft() == 0) {
+      // The event's budget ran out while the Interest was parked.
+      markMobility = false;
+      isMarked = false;
+    }
+    if (!isMarked) {
+      // The name check guards against two prefixes sharing a (frame, segment)
+      // when a single-stream producer serves any name under /LiveStream.
+      auto cached = stream.replyCache->find(frame, segment);
+      if (cached != nullptr && cached->getName() == name) {
+        m_replyCacheHits++;
+        sendSegment(stream, frame, segment, *cached);
+        return;
+      }
+    }
+
+    auto data = makeSegmentData(stream, name, frame, segment, markMobility, mobilitySeq);
+    if (isMarked) {
+      queueMarked(stream, frame, segment, std::move(data), true);
+      return;
+    }
+    stream.replyCache->insert(frame, segment, data);
+    sendSegment(stream, frame, segment, *data);
+  }
+
+  // The live edge advances by the producer's own wall-clock: frame N of a stream
+  // becomes available at its startTime + N*framePeriod. Computed on demand,
+  // independent of per-tick processing time, and requires no cross-node clock
+  // synchronisation.
+  static uint64_t
+  edgeNow(const Stream& stream)
+  {
+    auto elapsed = time::steady_clock::now() - stream.startTime;
+    if (elapsed.count() <= 0) {
+      return 0;
+    }
+    return static_cast<uint64_t>(elapsed / stream.interval);
+  }
+
+  // The instant at which frame N becomes available (N is produced at, not after,
+  // its boundary, so edgeNow() == N from this point on).
+  static time::steady_clock::time_point
+  frameStart(const Stream& stream, uint64_t frame)
+  {
+    return stream.startTime + stream.interval * frame;
+  }
+
+  // Release tick: serve every parked Interest of the stream whose frame has now
+  // been produced (frame <= edgeNow()). Mobility-marked Interests carry OptoFlood
+  // markers. Cost is proportional to the Interests that expire or become due,
+  // not to the number parked. Under EXP_FAIR_SERVE the due Interests are served
+  // round-robin across downstreams (see interleaveByDownstream).
+  void
+  advanceLiveEdgeAndServe(Stream& stream)
+  {
+    auto tickStart = time::steady_clock::now();
+    uint64_t edge = edgeNow(stream);
+
+    expirePending(stream, time::steady_clock::now());
+
+    // Serve every Interest whose frame has now been produced, except frames
+    // still being signed by the produce-ahead pipeline, which are held aside
+    // until the next tick.
+    for (const auto& entry : std::exchange(stream.heldForPipeline, {})) {
+      stream.releaseHeap.push(entry);
+    }
+    std::vector<PendingInterest> dueInterests;
+    while (!stream.releaseHeap.empty() && stream.releaseHeap.top().frame <= edge) {
+      PendingRelease top = stream.releaseHeap.top();
+      stream.releaseHeap.pop();
+      if (!isPending(stream, top)) {
+        continue;
+      }
+      if (isInFlight(stream, top.frame)) {
+        stream.heldForPipeline.push_back(top);
+        continue;
+      }
+      dueInterests.push_back(takePending(stream, top.slot));
+    }
+    if (m_fairServe) {
+      interleaveByDownstream(dueInterests);
+    }
+
+    for (const auto& pending : dueInterests) {
+      uint64_t frame = pending.frame;
+      auto due = frameStart(stream, frame);
+      if (pending.name.empty()) {
+        Name name(stream.prefix);
+        name.appendVersion(frame).appendSegment(pending.segment);
+        serveSegment(stream, name, frame, pending.segment, pending.markMobility,
+                     pending.mobilitySeq);
+      }
+      else {
+        serveSegment(stream, pending.name, frame, pending.segment, pending.markMobility,
+                     pending.mobilitySeq);
+      }
+      countDownstream(pending.downstream, &DownstreamStats::served);
+      auto now = time::steady_clock::now();
+      m_parkedLatency.record(now - pending.arrival);
+      m_stages.parkedToDue.record(due - pending.parked);
+      m_stages.dueToPut.record(now - due);
+    }
+
+    armRelease(stream);
+    m_stages.tick.record(time::steady_clock::now() - tickStart);
+  }
+
+  // Reorder one tick's due Interests round-robin across downstreams: one from
+  // each in turn, each downstream's own kept in frame and arrival order, and
+  // the downstream served first rotating from tick to tick. A downstream with a
+  // deep backlog then delays each other one by at most one reply per round.
+  void
+  interleaveByDownstream(std::vector<PendingInterest>& dueInterests)
+  {
+    std::unordered_map<uint64_t, size_t> queueOf;
+    std::vector<std::vector<size_t>> queues;
+    for (size_t i = 0; i < dueInterests.size(); ++i) {
+      auto [it, isNew] = queueOf.emplace(dueInterests[i].downstream, queues.size());
+      if (isNew) {
+        queues.emplace_back();
+      }
+      queues[it->second].push_back(i);
+    }
+    if (queues.size() <= 1) {
+      return;
+    }
+    std::rotate(queues.begin(), queues.begin() + m_fairRound++ % queues.size(), queues.end());
+
+    std::vector<PendingInterest> interleaved;
+    interleaved.reserve(dueInterests.size());
+    for (size_t round = 0; interleaved.size() < dueInterests.size(); ++round) {
+      for (const auto& queue : queues) {
+        if (round < queue.size()) {
+          interleaved.push_back(std::move(dueInterests[queue[round]]));
+        }
+      }
+    }
+    dueInterests = std::move(interleaved);
+  }
+
+  // The downstream an Interest came from: the NFD face it arrived on, from the
+  // IncomingFaceId NFD attaches once local fields are enabled; 0 without it.
+  static uint64_t
+  downstreamOf(const Interest& interest)
+  {
+    auto tag = interest.getTag<lp::IncomingFaceIdTag>();
+    return tag != nullptr ? tag->get() : 0;
+  }
+
+  void
+  countDownstream(uint64_t downstream, uint64_t DownstreamStats::*counter)
+  {
+    if (m_fairServe) {
+      m_downstreams[downstream].*counter += 1;
+    }
+  }
+
+  void
+  enableLocalFields()
+  {
+    m_nfdController = std::make_unique<nfd::Controller>(m_face, m_keyChain);
+    nfd::ControlParameters parameters;
+    parameters.setFlagBit(nfd::BIT_LOCAL_FIELDS_ENABLED, true);
+    m_nfdController->start<nfd::FaceUpdateCommand>(parameters,
+      [] (const nfd::ControlParameters&) {
+        std::cout << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                  << "] FAIR: Local fields enabled, downstreams identified by incoming face" << std::endl;
+      },
+      [] (const nfd::ControlResponse& response) {
+        std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                  << "] ERROR: Enabling local fields failed (" << response.getCode() << "): "
+                  << response.getText() << "; all Interests count as one downstream" << std::endl;
+      });
+  }
+
+  // Drop parked Interests whose lifetime has elapsed: the network PIT entry is
+  // gone, so any Data produced now would be unsolicited. Heap entries of
+  // Interests that were already served are discarded as they surface.
+  static void
+  expirePending(Stream& stream, time::steady_clock::time_point now)
+  {
+    while (!stream.expiryHeap.empty() && now >= stream.expiryHeap.top().expiry) {
+      PendingExpiry top = stream.expiryHeap.top();
+      stream.expiryHeap.pop();
+      if (isPending(stream, top)) {
+        takePending(stream, top.slot);
+      }
+    }
+  }
+
+  // Park an Interest: take a pool slot and index it for duplicates, release
+  // and expiry.
+  static void
+  parkPending(Stream& stream, PendingInterest pending, time::steady_clock::time_point expiry)
+  {
+    uint32_t slot = 0;
+    if (!stream.freePendingSlots.empty()) {
+      slot = stream.freePendingSlots.back();
+      stream.freePendingSlots.pop_back();
+    }
+    else {
+      slot = static_cast<uint32_t>(stream.pendingSlots.size());
+      stream.pendingSlots.emplace_back();
+    }
+    if (pending.name.empty()) {
+      stream.pendingKeys.insert(pending.frame, pending.segment);
+    }
+    else {
+      stream.pendingNames.insert(pending.name);
+    }
+    stream.releaseHeap.push(PendingRelease{pending.frame, pending.id, slot});
+    stream.expiryHeap.push(PendingExpiry{expiry, pending.id, slot});
+    stream.pendingSlots[slot] = std::move(pending);
+    stream.pendingCount++;
+  }
+
+  // Remove a parked Interest from the pool and the duplicate index; its heap
+  // entries go stale.
+  static PendingInterest
+  takePending(Stream& stream, uint32_t slot)
+  {
+    PendingInterest pending = std::exchange(stream.pendingSlots[slot], PendingInterest{});
+    if (pending.name.empty()) {
+      stream.pendingKeys.erase(pending.frame, pending.segment);
+    }
+    else {
+      stream.pendingNames.erase(pending.name);
+    }
+    stream.freePendingSlots.push_back(slot);
+    stream.pendingCount--;
+    return pending;
+  }
+
+  template<typename Entry>
+  static bool
+  isPending(const Stream& stream, const Entry& entry)
+  {
+    return stream.pendingSlots[entry.slot].id == entry.id;
+  }
+
+  void
+  onInterest(const Interest& interest)
+  {
+    auto arrival = time::steady_clock::now();
+    auto timestamp = std::chrono::system_clock::now().time_since_epoch().count();
+    m_interestCount++;
+
+    const Name& interestName = interest.getName();
+    uint16_t selectors = (interest.getCanBePrefix() ? 1 : 0) | (interest.getMustBeFresh() ? 2 : 0);
+    if (!m_eventLog ||
+        !m_eventLog->record(EventType::INTEREST_RECEIVED, interestName, m_interestCount,
+                            0, 0, 0, selectors)) {
+      std::cout << "[" << timestamp << "] INTEREST: Received #" << m_interestCount
+                << " Name: " << interestName
+                << " CanBePrefix: " << interest.getCanBePrefix()
+                << " MustBeFresh: " << interest.getMustBeFresh() << std::endl;
+    }
+
+    // Discovery: a bare "<stream>/_meta" Interest asks for the current live edge.
+    // Reply with a zero-freshness Data carrying the edge stamp, so a MustBeFresh
+    // discovery always reaches the producer instead of a cached copy.
+    if (!interestName.empty() && interestName.get(-1) == name::Component(DISCOVERY_MARKER)) {
+      Stream* stream = findStream(interestName.getPrefix(-1));
+      if (stream == nullptr) {
+        std::cerr << "[" << timestamp << "] INTEREST: Unknown stream, ignored Name: "
+                  << interestName << std::endl;
+        return;
+      }
+      serveOne(*stream, interestName, false, 0, 0_ms);
+      return;
+    }
+
+    // Statistics: "<stream>/_stats" is answered with this shard's counters and
+    // gauges, never cached (zero freshness); histograms are on EXP_STATS_SOCKET.
+    if (!interestName.empty() && interestName.get(-1) == name::Component(STATS_MARKER)) {
+      if (findStream(interestName.getPrefix(-1)) == nullptr) {
+        std::cerr << "[" << timestamp << "] INTEREST: Unknown stream, ignored Name: "
+                  << interestName << std::endl;
+        return;
+      }
+      sendData(*makeStatsData(interestName));
+      return;
+    }
+
+    // Content names follow /<stream>/<version=frame>/<segment>; the frame index
+    // gates production against the stream's live edge.
+    uint64_t frame = 0;
+    uint64_t segment = 0;
+    try {
+      if (interestName.size() >= 2 && interestName.get(-1).isSegment() &&
+          interestName.get(-2).isVersion()) {
+        frame = interestName.get(-2).toVersion();
+        segment = interestName.get(-1).toSegment();
+      }
+      else {
+        std::cerr << "[" << timestamp << "] INTEREST: Unrecognized name, ignored Name: "
+                  << interestName << std::endl;
+        return;
+      }
+    }
+    catch (const tlv::Error& e) {
+      std::cerr << "[" << timestamp << "] INTEREST: Failed to parse frame index: "
+                << e.what() << std::endl;
+      return;
+    }
+
+    Stream* stream = findStream(interestName.getPrefix(-2));
+    if (stream == nullptr) {
+      std::cerr << "[" << timestamp << "] INTEREST: Unknown stream, ignored Name: "
+                << interestName << std::endl;
+      return;
+    }
+    // Segments past the frame's last one (K-1, or K+R-1 with parity) do not
+    // exist; serving one would encode a parity segment that does not either.
+    if (segment >= static_cast<uint64_t>(segmentsFor(*stream, frame) + m_fecParity)) {
+      std::cerr << "[" << timestamp << "] INTEREST: Segment beyond FinalBlockId, ignored Name: "
+                << interestName << std::endl;
+      return;
+    }
+
+    uint64_t downstream = downstreamOf(interest);
+    countDownstream(downstream, &DownstreamStats::interests);
+    bool markMobility = shouldMarkArrival();
+    uint32_t mobilitySeq = markMobility ? static_cast<uint32_t>(m_mobilityEventCount) : 0;
+    // Only a name that rebuilds byte for byte from the stream prefix is keyed by
+    // (frame, segment); another prefix reaching the single-stream fallback, or a
+    // non-minimal number, could share that key with a different name.
+    bool isRebuildable = interestName.size() == stream->prefix.size() + 2 &&
+                         stream->prefix.isPrefixOf(interestName) &&
+                         interestName.get(-2).value_size() == encodingWidth(frame) &&
+                         interestName.get(-1).value_size() == encodingWidth(segment);
+    bool isDuplicate = isRebuildable ? stream->pendingKeys.contains(frame, segment)
+                                     : stream->pendingNames.count(interestName) > 0;
+    if (frame <= edgeNow(*stream) && !isInFlight(*stream, frame)) {
+      // The frame has already been produced: serve immediately (catch-up).
+      serveSegment(*stream, interestName, frame, segment, markMobility, mobilitySeq);
+      countDownstream(downstream, &DownstreamStats::served);
+    }
+    else if (!isDuplicate) {
+      // Future frame, or one the pipeline is still signing: hold the Interest
+      // until it can be served; drop it once its own lifetime elapses. Admission
+      // bounds both how far ahead it may ask and how many are held.
+      if (m_maxLookaheadFrames > 0 && frame > edgeNow(*stream) + m_maxLookaheadFrames) {
+        rejectInterest(*stream, interest, RejectReason::TOO_FAR_AHEAD);
+        countDownstream(downstream, &DownstreamStats::rejected);
+        return;
+      }
+      if (m_pendingCap > 0 && pendingTotal() >= m_pendingCap) {
+        rejectInterest(*stream, interest, RejectReason::TABLE_FULL);
+        countDownstream(downstream, &DownstreamStats::rejected);
+        return;
+      }
+      parkPending(*stream,
+                  PendingInterest{frame, isRebuildable ? Name() : interestName, segment,
+                                  ++m_pendingIdSeq, markMobility, mobilitySeq, arrival,
+                                  time::steady_clock::now(), downstream},
+                  time::steady_clock::now() + interest.getInterestLifetime());
+      countDownstream(downstream, &DownstreamStats::parked);
+      armRelease(*stream);
+      m_stages.arrivalToParked.record(time::steady_clock::now() - arrival);
+    }
+    else if (!m_eventLog || !m_eventLog->record(EventType::DUPLICATE_IGNORED, interestName)) {
+      std::cout << "[" << timestamp << "] INTEREST: Duplicate pending Interest ignored Name: "
+                << interestName << std::endl;
+    }
+
+    if (m_forceMobilityOnceFlag) {
+      m_forceMobilityOnceFlag = false;
+      m_mobilityHandler();
+    }
+  }
+
+private:
+  // Root under which every stream lives; registered and advertised as a whole.
+  static constexpr char STREAM_ROOT[] = "/LiveStream";
 
   boost::asio::io_context m_ioContext;
   Face m_face{m_ioContext};
   Scheduler m_scheduler;
   KeyChain m_keyChain;
+  ProducerShared& m_shared;
+  size_t m_shard = 0;
+  size_t m_shardCount = 1;
+  std::function<void()> m_mobilityHandler = [this] { onMobilityEvent(); };
+  bool m_isAdvertised = false;
+  std::unique_ptr<NlsrPrefixControl> m_nlsrControl;
+  bool m_fairServe = false;
+  std::unique_ptr<nfd::Controller> m_nfdController;
+  std::map<uint64_t, DownstreamStats> m_downstreams;
+  uint64_t m_fairRound = 0;
+  SigningMode m_signingMode = SigningMode::ECDSA;
+  security::SigningInfo m_signingInfo;
+  bool m_frameManifest = false;
+  bool m_dataTemplates = false;
+  int m_fecParity = 0;                        // R parity segments per frame
+  Name m_signingKeyName;                      // template signing, asymmetric modes
+  std::optional<HmacVerifier> m_hmacSigner;   // template signing, HMAC mode
+
+  // Streams are heap-allocated so their addresses stay valid for timer and
+  // worker callbacks.
+  std::vector<std::unique_ptr<Stream>> m_streams;
+  std::unordered_map<Name, Stream*> m_streamsByPrefix;
+
+  struct ReleaseJitterStats {
+    static constexpr uint64_t REPORT_EVERY = 500;
+    uint64_t count = 0;
+    uint64_t sumNs = 0;
+    uint64_t minNs = 0;
+    uint64_t maxNs = 0;
+  };
+  ReleaseJitterStats m_releaseJitter;
+
+  // Exported via <stream>/_stats and EXP_STATS_SOCKET.
+  LatencyHistogram m_parkedLatency;
+  LatencyHistogram m_releaseLateness;
+
+  // Hot-path stages of a parked Interest, plus signing and release ticks.
+  struct StageHistograms {
+    LatencyHistogram arrivalToParked;  // onInterest entry to parked
+    LatencyHistogram parkedToDue;      // parked to its frame's boundary
+    LatencyHistogram dueToPut;         // frame boundary to handed to the Face (or paced queue)
+    LatencyHistogram queued;           // waiting in the paced transmit queue
+    LatencyHistogram sign;             // inside KeyChain::sign (event-loop thread)
+    LatencyHistogram tick;             // one advanceLiveEdgeAndServe call
+
+    template<typename F>
+    void
+    forEach(F&& f) const
+    {
+      f("arrival_to_parked", arrivalToParked);
+      f("parked_to_due", parkedToDue);
+      f("due_to_put", dueToPut);
+      f("queued", queued);
+      f("sign", sign);
+      f("tick", tick);
+    }
+  };
+  StageHistograms m_stages;
+  boost::asio::signal_set m_signals{m_ioContext};
+  boost::asio::local::stream_protocol::acceptor m_statsAcceptor{m_ioContext};
+
+  // Batched transmit path: replies queued in the current tick, and batch sizes.
+  struct TxBatchStats {
+    static constexpr uint64_t REPORT_EVERY = 500;
+    uint64_t batches = 0;
+    uint64_t packets = 0;
+    uint64_t maxSize = 0;
+  };
+  bool m_batchTx = false;
+  std::vector<Data> m_txBatch;
+  TxBatchStats m_txBatchStats;
 
-  time::milliseconds m_interval{20};
-  int m_segmentsPerFrame = 1;
-  time::steady_clock::time_point m_startTime;
+  // Paced transmit path: replies ordered by urgency, then arrival.
+  struct TxEntry {
+    bool isSegment;   // non-segment replies first
+    uint64_t age;     // frames behind the live edge when queued
+    uint64_t segment;
+    uint64_t seq;
+    shared_ptr<const Data> data;
+    time::steady_clock::time_point queued;
+
+    bool
+    operator<(const TxEntry& other) const
+    {
+      return std::tie(isSegment, age, segment, seq) <
+             std::tie(other.isSegment, other.age, other.segment, other.seq);
+    }
+  };
+  double m_pacingBytesPerSec = 0;
+  double m_pacingBurstBytes = 0;
+  size_t m_pacingQueueCap = 0;
+  double m_tokens = 0;
+  time::steady_clock::time_point m_tokensUpdated;
+  std::set<TxEntry> m_txQueue;
+  uint64_t m_txSeq = 0;
+  uint64_t m_txQueueDropped = 0;
+  bool m_txDrainPending = false;
+  scheduler::ScopedEventId m_txPacingEvent;
 
   std::unique_ptr<NetlinkListener> m_netlinkListener;
+  NetlinkListener::Options m_mobilityOptions;
+
+  // Produce-ahead pipeline, shared by all streams.
+  static constexpr int MAX_FRAMES_IN_FLIGHT = 4;
+  int m_signWorkers = 0;
+  std::unique_ptr<boost::asio::thread_pool> m_signPool;
+  uint64_t m_pipelineFramesSkipped = 0;
+
+  /**
+   * @brief Which Data a mobility event floods. Each marked Data spends the
+   *        forwarders' per-producer flood rate limit, so marking is bounded.
+   *
+   * EXP_MARK_WINDOW_MS: Interests arriving this long after the event are marked
+   * too (default 0: only those parked at the event). EXP_MARK_BUDGET: marked
+   * Data per event and process, whichever shards send them, refresh burst
+   * included (default 0: unlimited); spent when a marked Data is sent.
+   * EXP_MARK_PRIORITY: order in which parked Interests, and then the marked
+   * replies sent in one tick across all streams, get the budget: oldest (release
+   * order, default), newest, or segment0 (first segments first).
+   */
+  struct MarkingPolicy {
+    enum class Priority { OLDEST, NEWEST, SEGMENT0 };
+
+    time::milliseconds window{0};
+    uint64_t budget = 0;
+    Priority priority = Priority::OLDEST;
+
+    static MarkingPolicy
+    fromEnv()
+    {
+      MarkingPolicy policy;
+      if (const char* raw = std::getenv("EXP_MARK_WINDOW_MS")) {
+        policy.window = time::milliseconds(std::max(0, std::atoi(raw)));
+      }
+      if (const char* raw = std::getenv("EXP_MARK_BUDGET")) {
+        policy.budget = static_cast<uint64_t>(std::max(0, std::atoi(raw)));
+      }
+      if (const char* raw = std::getenv("EXP_MARK_PRIORITY"); raw && raw[0] != '\0') {
+        std::string value(raw);
+        if (value == "oldest") {
+          policy.priority = Priority::OLDEST;
+        }
+        else if (value == "newest") {
+          policy.priority = Priority::NEWEST;
+        }
+        else if (value == "segment0") {
+          policy.priority = Priority::SEGMENT0;
+        }
+        else {
+          throw std::invalid_argument("Unknown EXP_MARK_PRIORITY '" + value +
+                                      "' (expected oldest, newest or segment0)");
+        }
+      }
+      return policy;
+    }
+  };
+
+  // Pending-table admission control.
+  size_t m_pendingCap = 0;
+  uint64_t m_maxLookaheadFrames = 0;
+  bool m_rejectWithNack = false;
+  std::array<uint64_t, 2> m_rejects{};
+
   bool m_enableOptoFlood = false;
+  MarkingPolicy m_markingPolicy;
+  time::steady_clock::time_point m_markWindowEnd{};
+  uint64_t m_markedSent = 0;
+  uint64_t m_unmarkedSent = 0;
+  // Marked segment replies of the current tick (see queueMarked).
+  struct MarkedReply {
+    Stream* stream = nullptr;
+    uint64_t frame = 0;
+    uint64_t segment = 0;
+    shared_ptr<const Data> data;
+    bool isSolicited = false;   // answers an Interest, rather than a refresh
+  };
+  std::vector<MarkedReply> m_markedWave;
+  uint64_t m_markBudgetExhausted = 0;
+  int m_mobilityRefreshFrames = 0;
   bool m_forceMobilityOnceFlag = false;
-  std::deque<PendingInterest> m_pendingInterests;
-  std::unordered_set<Name> m_pendingNames;
-  uint64_t m_floodIdSeq = 0;
-  
+  uint64_t m_pendingIdSeq = 0;
+
   // Statistics counters for experiment analysis
   uint64_t m_interestCount = 0;
   uint64_t m_dataCount = 0;
+  uint64_t m_replyCacheHits = 0;
   uint64_t m_mobilityEventCount = 0;
+  EventLog* m_eventLog = nullptr;
 };
 
+/**
+ * @brief Measure signing and verification throughput of every signing mode.
+ *
+ * Signs and verifies a Data shaped like a live-stream segment with throw-away
+ * keys in an in-memory KeyChain, so the producer's own PIB is left untouched.
+ */
+void
+runSigningBenchmark(int iterations)
+{
+  KeyChain keyChain("pib-memory:", "tpm-memory:");
+  auto ecdsaIdentity = keyChain.createIdentity("/bench/ecdsa", security::EcKeyParams());
+  auto rsaIdentity = keyChain.createIdentity("/bench/rsa", security::RsaKeyParams());
+  auto ecdsaCert = ecdsaIdentity.getDefaultKey().getDefaultCertificate();
+  auto rsaCert = rsaIdentity.getDefaultKey().getDefaultCertificate();
+  std::string hmacKey = hmacKeyFromEnv();
+  HmacVerifier hmacVerifier(hmacKey);
+
+  Data data(Name("/LiveStream/v0").appendVersion(1).appendSegment(0));
+  data.setFreshnessPeriod(10_s);
+  data.setFinalBlock(name::Component::fromSegment(0));
+  data.setContent(std::string_view("OptoFlood Test Data"));
+  MetaInfo metaInfo = data.getMetaInfo();
+  metaInfo.addAppMetaInfo(makeNonNegativeIntegerBlock(TLV_LIVE_EDGE, 1));
+  data.setMetaInfo(metaInfo);
+
+  for (auto mode : {SigningMode::ECDSA, SigningMode::RSA, SigningMode::HMAC, SigningMode::DIGEST}) {
+    security::SigningInfo info = makeSigningInfo(mode, hmacKey);
+    if (mode == SigningMode::ECDSA) {
+      info = security::signingByIdentity(ecdsaIdentity);
+    }
+    else if (mode == SigningMode::RSA) {
+      info = security::signingByIdentity(rsaIdentity);
+    }
+
+    auto signStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      keyChain.sign(data, info);
+    }
+    std::chrono::duration<double> signTime = std::chrono::steady_clock::now() - signStart;
+
+    int verified = 0;
+    auto verifyStart = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+      switch (mode) {
+        case SigningMode::ECDSA:
+          verified += security::verifySignature(data, ecdsaCert);
+          break;
+        case SigningMode::RSA:
+          verified += security::verifySignature(data, rsaCert);
+          break;
+        case SigningMode::HMAC:
+          verified += hmacVerifier.verify(data);
+          break;
+        case SigningMode::DIGEST:
+          verified += verifyDigestSignature(data);
+          break;
+      }
+    }
+    std::chrono::duration<double> verifyTime = std::chrono::steady_clock::now() - verifyStart;
+
+    std::cout << "BENCH: mode=" << toString(mode)
+              << " iterations=" << iterations
+              << " signs/s=" << std::fixed << std::setprecision(0) << iterations / signTime.count()
+              << " verifies/s=" << iterations / verifyTime.count()
+              << " size=" << data.wireEncode().size() << " bytes"
+              << " verified=" << verified << std::defaultfloat << std::endl;
+  }
+  std::cout << "BENCH: mode=ed25519 unsupported by this ndn-cxx KeyChain" << std::endl;
+}
+
+// Pin a thread to one core; shards are spread over the cores round-robin.
+void
+pinToCore(pthread_t thread, size_t index)
+{
+  unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(index % cores, &cpus);
+  int err = pthread_setaffinity_np(thread, sizeof(cpus), &cpus);
+  if (err != 0) {
+    std::cerr << "WARNING: Failed to pin producer shard " << index << ": "
+              << std::strerror(err) << std::endl;
+  }
+}
+
+// Run every shard's event loop on its own pinned thread; shard 0 runs on the
+// calling thread. Returns once all shards have stopped.
+void
+runShards(std::vector<std::unique_ptr<Producer>>& shards)
+{
+  if (shards.size() == 1) {
+    shards.front()->run();
+    return;
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < shards.size(); ++i) {
+    threads.emplace_back([&shard = *shards[i], i] {
+      try {
+        shard.run();
+      }
+      catch (const std::exception& e) {
+        std::cerr << "[" << std::chrono::system_clock::now().time_since_epoch().count()
+                  << "] FATAL: Exception in producer shard " << i << ": " << e.what() << std::endl;
+      }
+    });
+    pinToCore(threads.back().native_handle(), i);
+  }
+  pinToCore(pthread_self(), 0);
+
+  try {
+    shards.front()->run();
+  }
+  catch (const std::exception&) {
+    for (auto& shard : shards) {
+      shard->stop();
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    throw;
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
 } // namespace examples
 } // namespace ndn
 
 int
 main(int argc, char** argv)
 {
+  // --bench-signing[=N]: report signs/s and verifies/s per signing mode, then exit.
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("--bench-signing", 0) == 0) {
+      int iterations = 2000;
+      if (auto pos = arg.find('='); pos != std::string::npos) {
+        iterations = std::max(1, std::atoi(arg.c_str() + pos + 1));
+      }
+      try {
+        ndn::examples::runSigningBenchmark(iterations);
+      }
+      catch (const std::exception& e) {
+        std::cerr << "FATAL: Signing benchmark failed: " << e.what() << std::endl;
+        return 1;
+      }
+      return 0;
+    }
+  }
+
   auto startTime = std::chrono::system_clock::now().time_since_epoch().count();
   
   std::cout << "[" << startTime << "] STARTUP: Producer application starting" << std::endl;
   std::cout << "[" << startTime << "] STARTUP: Process ID: " << getpid() << std::endl;
 
   try {
-    ndn::examples::Producer producer;
+    // Sharded mode (EXP_PRODUCER_SHARDS=N > 1): N event loops on pinned threads,
+    // with the streams partitioned across them. Default 1, a single event loop.
+    const char* rawShards = std::getenv("EXP_PRODUCER_SHARDS");
+    int shardCount = rawShards ? std::atoi(rawShards) : 1;
+    if (shardCount <= 0) {
+      shardCount = 1;
+    }
+
+    ndn::examples::ProducerShared shared;
+    // Binary per-packet event log (EXP_EVENT_LOG=<file>); text logging otherwise.
+    shared.eventLog = ndn::examples::EventLog::openFromEnv();
+
+    // Segment content (EXP_PAYLOAD_FILE=<file> and/or EXP_SEGMENT_BYTES=<n>): byte
+    // ranges of a memory-mapped media file, or a synthetic pattern when only the
+    // size is given. Default: the fixed marker string.
+    const char* rawPayloadFile = std::getenv("EXP_PAYLOAD_FILE");
+    const char* rawSegmentBytes = std::getenv("EXP_SEGMENT_BYTES");
+    const char* rawFrameTrace = std::getenv("EXP_FRAME_TRACE");
+    std::string payloadFile = rawPayloadFile ? rawPayloadFile : "";
+    std::string frameTrace = rawFrameTrace ? rawFrameTrace : "";
+    int segmentBytes = rawSegmentBytes ? std::atoi(rawSegmentBytes) : 0;
+    if (!payloadFile.empty() || segmentBytes > 0 || !frameTrace.empty()) {
+      shared.payload = std::make_unique<ndn::examples::PayloadSource>(
+        payloadFile, segmentBytes > 0 ? segmentBytes : 1024);
+      std::cout << "[" << startTime << "] STARTUP: Payload "
+                << (payloadFile.empty() ? "synthetic" : payloadFile) << ", "
+                << shared.payload->segmentBytes() << " bytes per segment" << std::endl;
+    }
+
+    // Variable-bitrate frames (EXP_FRAME_TRACE=<file>): each frame's size, and so
+    // its segment count, follows the trace instead of a fixed K.
+    if (!frameTrace.empty()) {
+      const char* rawColumn = std::getenv("EXP_FRAME_TRACE_COLUMN");
+      shared.trace = std::make_unique<ndn::examples::FrameTrace>(
+        frameTrace, rawColumn ? std::atoi(rawColumn) : -1);
+      std::cout << "[" << startTime << "] STARTUP: Frame trace " << frameTrace << ", "
+                << shared.trace->frameCount() << " frames, mean "
+                << shared.trace->meanFrameBytes() << " bytes, max "
+                << shared.trace->maxFrameBytes() << " bytes" << std::endl;
+    }
+    std::vector<std::unique_ptr<ndn::examples::Producer>> shards;
+    for (int i = 0; i < shardCount; ++i) {
+      shards.push_back(std::make_unique<ndn::examples::Producer>(shared, i, shardCount));
+    }
+    // Shard 0 detects mobility and broadcasts every event to all shards.
+    if (shardCount > 1) {
+      shards.front()->setMobilityHandler([&shards] {
+        for (auto& shard : shards) {
+          shard->postMobilityEvent();
+        }
+      });
+    }
+
     // CLI flags retained but not required under solution build
     // --solution / --mode=solution: no-op in solution build (already enabled)
     // --force-mobility: Force one mobility event
     for (int i = 1; i < argc; ++i) {
       std::string arg = argv[i];
       if (arg == "--force-mobility") {
-        producer.forceMobilityOnce();
+        for (auto& shard : shards) {
+          shard->enableOptoFlood(true);
+        }
+        shards.front()->forceMobilityOnce();
       }
       else if (arg == "--solution" || arg == "--mode=solution") {
-        producer.enableOptoFlood(true);
+        for (auto& shard : shards) {
+          shard->enableOptoFlood(true);
+        }
       }
     }
-    std::cout << "[" << startTime << "] STARTUP: Producer initialized, starting event loop" << std::endl;
-    producer.run();
+    std::cout << "[" << startTime << "] STARTUP: Producer initialized with " << shardCount
+              << " shard(s), starting event loop" << std::endl;
+    ndn::examples::runShards(shards);
   }
   catch (const std::exception& e) {
     auto errorTime = std::chrono::system_clock::now().time_since_epoch().count();
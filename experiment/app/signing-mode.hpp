@@ -0,0 +1,188 @@
+// signing-mode.hpp
+
+#ifndef OPTOFLOOD_APP_SIGNING_MODE_HPP
+#define OPTOFLOOD_APP_SIGNING_MODE_HPP
+
+#include <ndn-cxx/data.hpp>
+#include <ndn-cxx/encoding/buffer-stream.hpp>
+#include <ndn-cxx/security/signing-helpers.hpp>
+#include <ndn-cxx/security/signing-info.hpp>
+#include <ndn-cxx/security/transform/base64-decode.hpp>
+#include <ndn-cxx/security/transform/buffer-source.hpp>
+#include <ndn-cxx/security/transform/private-key.hpp>
+#include <ndn-cxx/security/transform/signer-filter.hpp>
+#include <ndn-cxx/security/transform/stream-sink.hpp>
+#include <ndn-cxx/security/verification-helpers.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace ndn {
+namespace examples {
+
+/**
+ * @brief Signature algorithm used for application Data, selected by EXP_SIGNING.
+ *
+ * The producer signs with it and the consumer verifies with it, so both must
+ * run with the same value. The asymmetric modes sign with the producer's
+ * default identity, whose key type is chosen when the driver generates it
+ * (ndnsec key-gen); the consumer then checks them against the trust schema.
+ * The symmetric modes need no certificate and are verified directly.
+ *
+ * Ed25519 is not offered: the KeyChain of the pinned ndn-cxx cannot generate
+ * or sign with Ed25519 keys, so "ed25519" is rejected with an explicit error.
+ */
+enum class SigningMode {
+  ECDSA,   ///< SHA256withECDSA, default identity (default)
+  RSA,     ///< SHA256withRSA, default identity
+  HMAC,    ///< HMAC-SHA256 with a shared secret (EXP_HMAC_KEY)
+  DIGEST,  ///< DigestSha256: integrity only, no authentication
+};
+
+// Shared HMAC-SHA256 secret (base64, 32 bytes) used when EXP_HMAC_KEY is unset.
+// For experiments only: it authenticates nothing beyond this testbed.
+constexpr char DEFAULT_HMAC_KEY[] = "T3B0b0Zsb29kIGV4cGVyaW1lbnQgSE1BQyBrZXkhISE=";
+
+inline const char*
+toString(SigningMode mode)
+{
+  switch (mode) {
+    case SigningMode::ECDSA:
+      return "ecdsa";
+    case SigningMode::RSA:
+      return "rsa";
+    case SigningMode::HMAC:
+      return "hmac";
+    case SigningMode::DIGEST:
+      return "digest";
+  }
+  return "unknown";
+}
+
+inline SigningMode
+parseSigningMode(std::string_view value)
+{
+  if (value.empty() || value == "ecdsa") {
+    return SigningMode::ECDSA;
+  }
+  if (value == "rsa") {
+    return SigningMode::RSA;
+  }
+  if (value == "hmac") {
+    return SigningMode::HMAC;
+  }
+  if (value == "digest") {
+    return SigningMode::DIGEST;
+  }
+  if (value == "ed25519") {
+    throw std::invalid_argument("EXP_SIGNING=ed25519 is not supported by this ndn-cxx KeyChain");
+  }
+  throw std::invalid_argument("Unknown EXP_SIGNING value '" + std::string(value) +
+                              "' (expected ecdsa, rsa, hmac or digest)");
+}
+
+inline SigningMode
+signingModeFromEnv()
+{
+  const char* raw = std::getenv("EXP_SIGNING");
+  return parseSigningMode(raw ? raw : "");
+}
+
+inline std::string
+hmacKeyFromEnv()
+{
+  const char* raw = std::getenv("EXP_HMAC_KEY");
+  return raw && raw[0] != '\0' ? raw : DEFAULT_HMAC_KEY;
+}
+
+inline bool
+isAsymmetric(SigningMode mode)
+{
+  return mode == SigningMode::ECDSA || mode == SigningMode::RSA;
+}
+
+// Value of the trust schema's "sig-type" for the asymmetric modes.
+inline const char*
+trustSchemaSigType(SigningMode mode)
+{
+  return mode == SigningMode::RSA ? "rsa-sha256" : "ecdsa-sha256";
+}
+
+// SigningInfo for the producer. The asymmetric modes use the default identity.
+inline security::SigningInfo
+makeSigningInfo(SigningMode mode, const std::string& hmacKey)
+{
+  switch (mode) {
+    case SigningMode::HMAC: {
+      security::SigningInfo info;
+      info.setSigningHmacKey(hmacKey);
+      return info;
+    }
+    case SigningMode::DIGEST:
+      return security::signingWithSha256();
+    case SigningMode::ECDSA:
+    case SigningMode::RSA:
+      break;
+  }
+  return security::SigningInfo();
+}
+
+/**
+ * @brief Verifies HMAC-SHA256 signed Data against the shared secret, and
+ *        computes such signatures over raw signed portions.
+ */
+class HmacVerifier
+{
+public:
+  explicit
+  HmacVerifier(const std::string& base64Key)
+  {
+    using namespace security::transform;
+    OBufferStream os;
+    bufferSource(base64Key) >> base64Decode(false) >> streamSink(os);
+    m_key.loadRaw(KeyType::HMAC, *os.buf());
+  }
+
+  ConstBufferPtr
+  sign(span<const uint8_t> signedPortion) const
+  {
+    using namespace security::transform;
+    OBufferStream os;
+    bufferSource(signedPortion) >> signerFilter(DigestAlgorithm::SHA256, m_key) >> streamSink(os);
+    return os.buf();
+  }
+
+  bool
+  verify(const Data& data) const
+  {
+    using namespace security::transform;
+    if (data.getSignatureInfo().getSignatureType() != tlv::SignatureHmacWithSha256) {
+      return false;
+    }
+    OBufferStream os;
+    bufferSource(data.extractSignedRanges()) >> signerFilter(DigestAlgorithm::SHA256, m_key)
+                                             >> streamSink(os);
+    const Block& sigValue = data.getSignatureValue();
+    const Buffer& expected = *os.buf();
+    return sigValue.value_size() == expected.size() &&
+           std::equal(expected.begin(), expected.end(), sigValue.value());
+  }
+
+private:
+  security::transform::PrivateKey m_key;
+};
+
+inline bool
+verifyDigestSignature(const Data& data)
+{
+  return data.getSignatureInfo().getSignatureType() == tlv::DigestSha256 &&
+         security::verifyDigest(data, DigestAlgorithm::SHA256);
+}
+
+} // namespace examples
+} // namespace ndn
+
+#endif // OPTOFLOOD_APP_SIGNING_MODE_HPP
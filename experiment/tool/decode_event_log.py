@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Decode a binary app event log (EXP_EVENT_LOG) into the apps' text log lines."""
+
+from __future__ import annotations
+
+import argparse
+import struct
+import sys
+from typing import BinaryIO, Iterator, TextIO
+
+# Must match experiment/app/event-log.hpp.
+_MAGIC = b"OFEVLOG1"
+_HEADER = struct.Struct("=8sIIqq")
+_RECORD = struct.Struct("=QHHIQQQQQQ")
+
+_PREFIX = 1
+_DROPPED = 2
+_INTEREST_RECEIVED = 3
+_DUPLICATE_IGNORED = 4
+_MOBILITY_MARKED = 5
+_DATA_SENT = 6
+_INTEREST_SENT = 7
+_DATA_RECEIVED = 8
+_VALIDATED = 9
+_FRAME_STARTED = 10
+_FRAME_DELIVERED = 11
+_INTEREST_REJECTED = 12
+
+_REJECT_REASONS = ("too_far_ahead", "table_full")
+
+Record = tuple[int, int, int, int, int, int, int, int, int, int]
+
+
+def _read_records(stream: BinaryIO) -> Iterator[Record]:
+    """Yield records with timestamps converted to system-clock nanoseconds."""
+    header = stream.read(_HEADER.size)
+    if len(header) < _HEADER.size:
+        raise ValueError("truncated event log header")
+    magic, record_size, _, steady_base, system_base = _HEADER.unpack(header)
+    if magic != _MAGIC or record_size != _RECORD.size:
+        raise ValueError("not an event log, or written by an incompatible version")
+
+    while True:
+        chunk = stream.read(_RECORD.size)
+        if len(chunk) < _RECORD.size:
+            return  # a killed app may leave a partial last record
+        fields = _RECORD.unpack(chunk)
+        yield (fields[0] - steady_base + system_base,) + fields[1:]
+
+
+def _unpack_prefix(record: Record) -> str:
+    """Return the prefix URI packed into the payload of a PREFIX record."""
+    payload = struct.pack("=6Q", *record[4:])
+    return payload.rstrip(b"\0").decode("utf-8")
+
+
+def _format(record: Record, prefixes: dict[int, str]) -> list[str]:
+    """Return the text lines one record stands for."""
+    ts, kind, flags, prefix_id, frame, segment, a, b, c, d = record
+    name = f"{prefixes.get(prefix_id, '')}/v={frame}/seg={segment}"
+
+    if kind == _INTEREST_RECEIVED:
+        return [f"[{ts}] INTEREST: Received #{a} Name: {name}"
+                f" CanBePrefix: {flags & 1} MustBeFresh: {(flags >> 1) & 1}"]
+    if kind == _DUPLICATE_IGNORED:
+        return [f"[{ts}] INTEREST: Duplicate pending Interest ignored Name: {name}"]
+    if kind == _INTEREST_REJECTED:
+        reason = _REJECT_REASONS[flags] if flags < len(_REJECT_REASONS) else "unknown"
+        return [f"[{ts}] INTEREST: Rejected ({reason}) Name: {name}"]
+    if kind == _MOBILITY_MARKED:
+        return [f"[{ts}] DATA: Attaching OptoFlood mobility markers"
+                f" NewFaceSeq: {b} FloodId: {a}"]
+    if kind == _DATA_SENT:
+        return [f"[{ts}] DATA: Sending response Size: {a} bytes Name: {name}",
+                f"[{ts}] STATS: Total Interests: {b} Total Data sent: {c}"
+                f" Reply cache hits: {d}"]
+    if kind == _INTEREST_SENT:
+        return [f"[{ts}] SEND: frame={frame} seg={segment} Name: {name}"]
+    if kind == _DATA_RECEIVED:
+        return [f"[{ts}] DATA: frame={frame} seg={segment} Size: {a} bytes"]
+    if kind == _VALIDATED:
+        what = "digest matches frame manifest" if flags == 1 else "signature verified"
+        return [f"[{ts}] VALIDATE: Data {what}"]
+    if kind == _FRAME_STARTED:
+        return [f"[{ts}] FRAME: start frame={frame}"]
+    if kind == _FRAME_DELIVERED:
+        return [f"[{ts}] FRAME: delivered frame={frame} latency_ms={a / 1e6:g}"
+                f" (delivered {b}, lost {c}, skipped {d})"]
+    if kind == _DROPPED:
+        return [f"[{ts}] EVENTLOG: dropped {a} records (ring full)"]
+    return [f"[{ts}] EVENTLOG: unknown record type {kind}"]
+
+
+def decode(stream: BinaryIO, output: TextIO) -> int:
+    """Write the text form of every record; return the number of records read."""
+    prefixes: dict[int, str] = {}
+    count = 0
+    for record in _read_records(stream):
+        count += 1
+        if record[1] == _PREFIX:
+            prefixes[record[3]] = _unpack_prefix(record)
+            continue
+        for line in _format(record, prefixes):
+            output.write(line + "\n")
+    return count
+
+
+def main() -> None:
+    """Parse CLI arguments and decode one event log."""
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("event_log", help="Binary log written via EXP_EVENT_LOG")
+    parser.add_argument("-o", "--output", help="Text output (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.event_log, "rb") as stream:
+        if args.output:
+            with open(args.output, "w", encoding="utf-8") as output:
+                decode(stream, output)
+        else:
+            decode(stream, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
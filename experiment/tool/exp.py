@@ -49,6 +49,17 @@ DEFAULT_HANDOFF_INTERVAL_JITTER = 0.0
 PRODUCER_IDENTITY = '/LiveStream'
 TRUST_ANCHOR_FILE = '/home/vagrant/flooding/experiment/app/livestream-trust-anchor.cert'
 
+# Application signing modes (EXP_SIGNING, shared by producer and consumer) and the
+# `ndnsec key-gen -t` key type generated for the producer identity in each. The
+# symmetric modes do not use the identity key, which is still generated so the
+# producer has a default identity.
+SIGNING_MODE_KEY_TYPES: Dict[str, str] = {
+    'ecdsa': 'e',
+    'rsa': 'r',
+    'hmac': 'e',
+    'digest': 'e',
+}
+
 # Access points that must start down so the experiment begins with the producer
 # attached only via acc2.
 NON_INITIAL_ACCESS_POINTS: Tuple[str, ...] = ('acc3', 'acc4', 'acc5', 'acc6')
@@ -163,6 +174,16 @@ def _load_request_interval_ms() -> int:
     return value
 
 
+def _load_signing_mode() -> str:
+    """Read the application signing mode (EXP_SIGNING, default ecdsa)."""
+    value = (os.getenv('EXP_SIGNING') or '').strip().lower() or 'ecdsa'
+    if value not in SIGNING_MODE_KEY_TYPES:
+        raise ValueError(
+            f'Invalid EXP_SIGNING: {value} (expected one of {", ".join(SIGNING_MODE_KEY_TYPES)})'
+        )
+    return value
+
+
 def _load_positive_int_env(name: str, default: int) -> int:
     """Read a positive-integer experiment parameter from the environment."""
     raw_value = (os.getenv(name) or '').strip()
@@ -344,6 +365,7 @@ if __name__ == '__main__':
         request_interval_ms = _load_request_interval_ms()
         window_frames = _load_positive_int_env('EXP_WINDOW_FRAMES', 4)
         segments_per_frame = _load_positive_int_env('EXP_SEGMENTS_PER_FRAME', 1)
+        signing_mode = _load_signing_mode()
     except ValueError as error:
         print(f"Error: {error}")
         exit(1)
@@ -390,7 +412,8 @@ if __name__ == '__main__':
     # signed under /LiveStream. The self-signed certificate is exported to the path
     # referenced by the consumer trust schema. NLSR prefix-update validation is
     # disabled here, so changing the default identity does not affect advertisement.
-    producer.cmd('ndnsec key-gen {} >/dev/null 2>&1'.format(PRODUCER_IDENTITY))
+    producer.cmd('ndnsec key-gen -t {} {} >/dev/null 2>&1'.format(
+        SIGNING_MODE_KEY_TYPES[signing_mode], PRODUCER_IDENTITY))
     producer.cmd('ndnsec cert-dump -i {} > {}'.format(PRODUCER_IDENTITY, TRUST_ANCHOR_FILE))
 
     consumer_pcap = os.path.join(results_dir, "consumer_capture.pcap")
@@ -410,14 +433,25 @@ if __name__ == '__main__':
 
     app_env = (f"EXP_REQUEST_INTERVAL_MS={request_interval_ms}"
                f" EXP_WINDOW_FRAMES={window_frames}"
-               f" EXP_SEGMENTS_PER_FRAME={segments_per_frame}")
+               f" EXP_SEGMENTS_PER_FRAME={segments_per_frame}"
+               f" EXP_SIGNING={signing_mode}")
+    hmac_key = os.getenv('EXP_HMAC_KEY')
+    if hmac_key:
+        app_env += f" EXP_HMAC_KEY={quote(hmac_key)}"
     # Optional stream selection for multi-stream studies (default /LiveStream/v0
     # is applied by the consumer when unset).
     stream_prefix = os.getenv('EXP_STREAM_PREFIX')
     if stream_prefix:
         app_env += f" EXP_STREAM_PREFIX={quote(stream_prefix)}"
-    producer.cmd(f"{app_env} {producer_exec} &> {producer_log} &")
-    consumer.cmd(f"{app_env} {consumer_exec} &> {consumer_log} &")
+    # Optional binary per-packet event logs (EXP_EVENT_LOG=1), one file per app
+    # next to its text log; decode_event_log.py restores the text lines. Always
+    # set explicitly so the apps never share the inherited value as a path.
+    producer_events = consumer_events = "''"
+    if (os.getenv('EXP_EVENT_LOG') or '').strip() not in ('', '0'):
+        producer_events = quote(os.path.join(experiment_dir, "results", "producer.events"))
+        consumer_events = quote(os.path.join(experiment_dir, "results", "consumer.events"))
+    producer.cmd(f"{app_env} EXP_EVENT_LOG={producer_events} {producer_exec} &> {producer_log} &")
+    consumer.cmd(f"{app_env} EXP_EVENT_LOG={consumer_events} {consumer_exec} &> {consumer_log} &")
 
     # The handoff loop runs K randomly-spaced toggles along handoff_sequence.
     # The first interval doubles as application warm-up before handoff #1.